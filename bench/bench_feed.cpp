@@ -0,0 +1,120 @@
+// Synthetic feed throughput on one core: the previous MdFeed::next (per-event
+// mt19937_64 + uniform_real_distribution, double mid, llround timestamp) versus
+// MdFeed::next, the engine's per-event path, and MdFeed::next_batch. The two
+// per-event paths are driven with timestamps advancing as in the producer loop.
+//
+//   ./bench_feed [--events N] [--symbols S] [--zipf Z] [--corr RHO] [--batch B]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mdfeed.hpp"
+
+using namespace nhft;
+using clk = std::chrono::steady_clock;
+
+namespace {
+
+double secs_since(clk::time_point t0) {
+  return std::chrono::duration<double>(clk::now() - t0).count();
+}
+
+// MdFeed::next as it was before the batched generator, kept verbatim
+struct PrevEvent {
+  uint64_t ts_ns;
+  int symbol;
+  double mid;
+  double spread;
+};
+
+class PrevFeed {
+public:
+  explicit PrevFeed(int symbols, uint64_t seed) : S_(symbols), rng_(seed), mids_(symbols) {
+    for (int i=0;i<S_;++i) mids_[i] = 100.0 + i;
+  }
+  PrevEvent next(double now_s) {
+    sym_idx_ = (sym_idx_ + 1) % S_;
+    std::uniform_real_distribution<double> u(-0.01, 0.01);
+    mids_[sym_idx_] = std::max(0.01, mids_[sym_idx_] * (1.0 + u(rng_)));
+    PrevEvent ev{};
+    ev.symbol = sym_idx_;
+    ev.mid = mids_[sym_idx_];
+    ev.spread = 0.01;
+    ev.ts_ns = (uint64_t)std::llround(now_s * 1e9);
+    return ev;
+  }
+private:
+  int S_;
+  std::mt19937_64 rng_;
+  std::vector<double> mids_;
+  int sym_idx_ = -1;
+};
+
+volatile uint64_t ts_sink; // keeps the per-event timestamp conversions live
+
+void report(const char* name, uint64_t events, double s, double sink) {
+  std::printf("%-12s %8.1f M events/s  (%.3f s, checksum %.6f)\n", name, events / s / 1e6, s, sink);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  uint64_t events = 50000000;
+  int S = 64;
+  size_t batch = 1024;
+  FeedConfig cfg;
+  for (int i=1;i<argc;++i) {
+    std::string a = argv[i];
+    auto next = [&]{ return (i+1<argc)? std::string(argv[++i]) : std::string(); };
+    if (a == "--events") events = std::stoull(next());
+    else if (a == "--symbols") S = std::stoi(next());
+    else if (a == "--zipf") cfg.zipf = std::stod(next());
+    else if (a == "--corr") cfg.corr = std::stod(next());
+    else if (a == "--batch") batch = std::max<size_t>(1, std::stoull(next()));
+  }
+  std::printf("events=%llu symbols=%d zipf=%.2f corr=%.2f batch=%zu\n",
+              (unsigned long long)events, S, cfg.zipf, cfg.corr, batch);
+
+  // Previous MdFeed::next: round-robin only, so --zipf and --corr do not apply
+  {
+    PrevFeed feed(S, 7);
+    double sink = 0.0;
+    auto t0 = clk::now();
+    for (uint64_t i=0;i<events;++i) {
+      PrevEvent ev = feed.next(i * 1e-8);
+      sink += ev.mid;
+      ts_sink = ev.ts_ns;
+    }
+    report("previous", events, secs_since(t0), sink / events);
+  }
+
+  {
+    MdFeed feed(S, 0, 7, {}, false, cfg);
+    double sink = 0.0;
+    auto t0 = clk::now();
+    for (uint64_t i=0;i<events;++i) {
+      MdEvent ev = feed.next(i * 1e-8);
+      sink += ev.bid;
+      ts_sink = ev.ts_ns;
+    }
+    report("next", events, secs_since(t0), sink / events);
+  }
+
+  {
+    MdFeed feed(S, 0, 7, {}, false, cfg);
+    std::vector<MdEvent> buf(batch);
+    double sink = 0.0;
+    auto t0 = clk::now();
+    for (uint64_t i=0;i<events;i+=batch) {
+      size_t n = (size_t)std::min<uint64_t>(batch, events - i);
+      feed.next_batch(0.0, buf.data(), n);
+      for (size_t k=0;k<n;++k) sink += buf[k].bid;
+    }
+    report("next_batch", events, secs_since(t0), sink / events);
+  }
+  return 0;
+}
@@ -0,0 +1,108 @@
+// Order lifecycle manager against a simulated gateway on one thread: submit
+// and hold a book of live orders, then churn it with acks, partial fills,
+// rejects, cancels (some refused) and lost messages that leave orders in doubt
+// until a cancel settles them.
+//
+//   ./bench_orders [--orders N] [--live L] [--seed S]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "alloc_tracker.hpp"
+#include "order_manager.hpp"
+
+using namespace nhft;
+using clk = std::chrono::steady_clock;
+
+int main(int argc, char** argv) {
+  uint64_t orders = 5000000;
+  uint32_t live = 50000;
+  uint64_t seed = 7;
+  for (int i=1;i<argc;++i) {
+    std::string a = argv[i];
+    auto next = [&]{ return (i+1<argc)? std::string(argv[++i]) : std::string(); };
+    if (a == "--orders") orders = std::stoull(next());
+    else if (a == "--live") live = (uint32_t)std::max(1, std::stoi(next()));
+    else if (a == "--seed") seed = std::stoull(next());
+  }
+
+  OrderManagerConfig cfg;
+  cfg.max_orders = live;
+  cfg.ack_timeout_ns = 200000; // simulated: 1 ns per step
+  SpscRing<OrderRequest> to_gw(1u << 17);
+  SpscRing<GatewayEvent> from_gw(1u << 17);
+  OrderManager om(cfg, to_gw);
+  std::mt19937_64 rng(seed);
+  std::vector<uint64_t> book; // acked orders the gateway is working
+  book.reserve(2 * (size_t)live); // refused cancels re-add IDs
+
+  // Gateway: answers each request in arrival order. New: 1% rejected, 0.1% lost,
+  // else acked. Working orders get a partial or full fill or an unsolicited cancel.
+  auto gateway = [&](uint64_t now) {
+    OrderRequest r;
+    while (to_gw.pop(r)) {
+      uint32_t x = (uint32_t)rng() % 1000;
+      if (r.type == RequestType::cancel) {
+        bool refuse = x < 5; // the order keeps working
+        from_gw.push(GatewayEvent{r.order_id, now, 0, 0, refuse ? GatewayEventType::reject : GatewayEventType::cancelled});
+        if (refuse) book.push_back(r.order_id);
+      } else if (x < 10) {
+        from_gw.push(GatewayEvent{r.order_id, now, 0, 0, GatewayEventType::reject});
+      } else if (x >= 11) {
+        from_gw.push(GatewayEvent{r.order_id, now, 0, 0, GatewayEventType::ack});
+        book.push_back(r.order_id);
+      }
+    }
+  };
+
+  std::printf("orders=%llu live=%u frame_bytes=%zu\n", (unsigned long long)orders, live, cfg.frame_bytes);
+  alloc_set_phase(AllocPhase::hot);
+  auto a0 = alloc_thread_stats();
+  auto t0 = clk::now();
+  uint64_t now = 0, submitted = 0;
+  while (submitted < orders) {
+    ++now;
+    if (om.live() < live && om.submit((int)(submitted % 64), (submitted & 1) ? 1 : -1, 4, 100, now)) ++submitted;
+    if ((now & 63) == 0 || om.live() == live) {
+      gateway(now);
+      // Work a few acked orders: fill, cancel, or cancel unsolicited
+      for (int k=0;k<64 && !book.empty();++k) {
+        size_t j = (size_t)(rng() % book.size());
+        uint64_t id = book[j];
+        OrderState st; int64_t filled;
+        if (!om.find(id, st, filled)) { book[j] = book.back(); book.pop_back(); continue; } // filled out
+        uint32_t x = (uint32_t)rng() % 100;
+        if (x < 70) from_gw.push(GatewayEvent{id, now, x < 35 ? 2 : 4, 100, GatewayEventType::fill});
+        else if (x < 90) om.cancel(id, now);
+        else from_gw.push(GatewayEvent{id, now, 0, 0, GatewayEventType::cancelled});
+        if (x < 35 || x >= 70) continue;
+        book[j] = book.back();
+        book.pop_back();
+      }
+      om.poll(from_gw, now, 1u << 16);
+    }
+  }
+  while (om.live() > 0) { // drain: cancel what is left
+    now += 1000;
+    for (uint64_t id : book) om.cancel(id, now);
+    book.clear();
+    gateway(now);
+    om.poll(from_gw, now, 1u << 16);
+  }
+  double s = std::chrono::duration<double>(clk::now() - t0).count();
+  auto a1 = alloc_thread_stats();
+  alloc_set_phase(AllocPhase::report);
+
+  const auto& st = om.stats();
+  std::printf("%.2f M orders/s with the simulated gateway, %.1f ns per resume (%.3f s)\n", orders / s / 1e6, s * 1e9 / st.resumes, s);
+  std::printf("filled=%llu cancelled=%llu rejected=%llu timed_out=%llu in_doubt=%llu unknown=%llu resumes=%llu\n",
+              (unsigned long long)st.filled, (unsigned long long)st.cancelled, (unsigned long long)st.rejected,
+              (unsigned long long)st.timed_out, (unsigned long long)st.in_doubt, (unsigned long long)st.unknown_events,
+              (unsigned long long)st.resumes);
+  if (alloc_tracking_enabled())
+    std::printf("hot allocations: %llu\n", (unsigned long long)alloc_diff(a0, a1, AllocPhase::hot).allocs);
+  return 0;
+}
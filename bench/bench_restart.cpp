@@ -0,0 +1,106 @@
+// Time-to-first-decision after a restart: cold (replay the session to rebuild
+// Strategy/Risk/Router state) versus warm (remap the state file and restore).
+//
+//   ./bench_restart [--events N] [--symbols S] [--state PATH]
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include "mdfeed.hpp"
+#include "strategy.hpp"
+#include "risk.hpp"
+#include "router.hpp"
+#include "snapshot.hpp"
+#include "util.hpp"
+
+using namespace nhft;
+using clk = std::chrono::steady_clock;
+
+namespace {
+
+struct Session {
+  Strategy strat;
+  Risk risk;
+  Router router;
+  uint64_t seq = 0;
+  Session(int S, const std::string& trades) : strat(S), risk(TickTable(S)), router(7, trades, TickTable(S)) {}
+
+  // One pipeline step, mirroring the engine's consumer loop
+  Decision step(const MdEvent& ev, StateFile* st) {
+    Decision d = strat.on_mid(ev.symbol, ev.mid2());
+    int64_t px = Router::ioc_price(d.side, ev.bid, ev.ask());
+    if (d.side != 0 && risk.check(ev.symbol, d.side, d.qty, px).allowed) {
+      uint64_t oid = fnv1a64(&(++seq), sizeof(seq));
+      router.ioc_fill(oid, ev.ts_ns, ev.symbol, d.side, d.qty, px, "bench");
+      risk.on_fill(ev.symbol, d.side, d.qty, px);
+      if (st) st->record_fill(oid, seq, ev.symbol, d.side, d.qty, px);
+    }
+    return d;
+  }
+};
+
+double ms_since(clk::time_point t0) {
+  return std::chrono::duration<double, std::milli>(clk::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  uint64_t events = 2000000;
+  int S = 4;
+  std::string path = "out/bench_restart/engine.state";
+  for (int i=1;i<argc;++i) {
+    std::string a = argv[i];
+    auto next = [&]{ return (i+1<argc)? std::string(argv[++i]) : std::string(); };
+    if (a == "--events") events = std::stoull(next());
+    else if (a == "--symbols") S = std::stoi(next());
+    else if (a == "--state") path = next();
+  }
+  std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+  std::filesystem::remove(path);
+  const std::string devnull = "/dev/null";
+
+  // Original session, checkpointing as the engine does
+  {
+    MdFeed feed(S, 100000, 7, {});
+    Session s(S, devnull);
+    StateFile st;
+    if (!st.open(path, TickTable(S))) { std::fprintf(stderr, "state file unavailable\n"); return 1; }
+    for (uint64_t i=0;i<events;++i) {
+      s.step(feed.next(i * 1e-5), &st);
+      if ((i + 1) % 4096 == 0) st.checkpoint(s.strat, s.risk, EngineCursor{i + 1, s.seq});
+    }
+    st.checkpoint(s.strat, s.risk, EngineCursor{events, s.seq});
+  }
+
+  MdEvent probe{0, 10000, 0, 1};
+
+  // Cold: rebuild state by replaying the whole session, then decide
+  auto t0 = clk::now();
+  {
+    MdFeed feed(S, 100000, 7, {});
+    Session s(S, devnull);
+    for (uint64_t i=0;i<events;++i) s.step(feed.next(i * 1e-5), nullptr);
+    s.step(probe, nullptr);
+  }
+  double cold_ms = ms_since(t0);
+
+  // Warm: remap the checkpoint, validate, restore, then decide
+  t0 = clk::now();
+  {
+    Session s(S, devnull);
+    StateFile st;
+    EngineCursor cur;
+    if (!st.open(path, TickTable(S)) || !st.restore(s.strat, s.risk, s.router, cur)) { std::fprintf(stderr, "restore failed\n"); return 1; }
+    s.seq = cur.order_seq;
+    s.step(probe, &st);
+  }
+  double warm_ms = ms_since(t0);
+
+  std::printf("events=%llu symbols=%d\n", (unsigned long long)events, S);
+  std::printf("cold ttfd_ms=%.3f\n", cold_ms);
+  std::printf("warm ttfd_ms=%.3f\n", warm_ms);
+  std::printf("speedup: %.1fx\n", warm_ms > 0 ? cold_ms / warm_ms : 0.0);
+  return 0;
+}
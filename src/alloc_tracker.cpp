@@ -0,0 +1,127 @@
+#include "alloc_tracker.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+namespace nhft {
+
+namespace {
+// Plain thread_locals with trivial types: no TLS init guard, no allocation
+thread_local AllocThreadStats tl_stats;
+thread_local AllocPhase tl_phase = AllocPhase::setup;
+thread_local bool tl_forbid = false;
+thread_local bool tl_log_stack = false;
+thread_local bool tl_in_hook = false;
+constexpr uint64_t kMaxStacksLogged = 4;
+} // namespace
+
+bool alloc_tracking_enabled() {
+#ifdef NANOHFT_ALLOC_TRACKING
+  return true;
+#else
+  return false;
+#endif
+}
+
+void alloc_set_phase(AllocPhase p) { tl_phase = p; }
+AllocPhase alloc_phase() { return tl_phase; }
+AllocThreadStats alloc_thread_stats() { return tl_stats; }
+
+AllocStats alloc_diff(const AllocThreadStats& before, const AllocThreadStats& after, AllocPhase p) {
+  AllocStats d;
+  d.allocs = after[p].allocs - before[p].allocs;
+  d.bytes = after[p].bytes - before[p].bytes;
+  return d;
+}
+
+void alloc_forbid_hot(bool on, bool log_stack) {
+  tl_forbid = on;
+  tl_log_stack = log_stack;
+#if defined(__GLIBC__)
+  // First backtrace() call loads libgcc; do it now rather than inside the hook
+  if (on && log_stack) { void* frames[1]; backtrace(frames, 1); }
+#endif
+}
+
+#ifdef NANOHFT_ALLOC_TRACKING
+static void on_alloc(std::size_t n) {
+  AllocStats& s = tl_stats.phase[(int)tl_phase];
+  s.allocs++;
+  s.bytes += n;
+  if (tl_forbid && tl_phase == AllocPhase::hot && !tl_in_hook) {
+    tl_in_hook = true;
+    if (tl_stats.violations++ < kMaxStacksLogged && tl_log_stack) {
+      std::fprintf(stderr, "[error] hot-path allocation of %zu bytes\n", n);
+#if defined(__GLIBC__)
+      void* frames[32];
+      int depth = backtrace(frames, 32);
+      backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+#endif
+    }
+    tl_in_hook = false;
+  }
+}
+
+static void* alloc_or_throw(std::size_t n) {
+  on_alloc(n);
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+
+static void* aligned_alloc_or_null(std::size_t n, std::align_val_t al) {
+  on_alloc(n);
+  void* p = nullptr;
+  std::size_t a = (std::size_t)al < sizeof(void*) ? sizeof(void*) : (std::size_t)al;
+  if (posix_memalign(&p, a, n ? n : 1) != 0) return nullptr;
+  return p;
+}
+
+static void release(void* p) noexcept {
+  if (!p) return;
+  tl_stats.frees++;
+  std::free(p);
+}
+#endif
+
+} // namespace nhft
+
+#ifdef NANOHFT_ALLOC_TRACKING
+// Replaceable global allocation functions ([new.delete]); aligned variants use
+// posix_memalign, whose memory is also released with free().
+void* operator new(std::size_t n) { return nhft::alloc_or_throw(n); }
+void* operator new[](std::size_t n) { return nhft::alloc_or_throw(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept {
+  try { return nhft::alloc_or_throw(n); } catch (...) { return nullptr; }
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept {
+  try { return nhft::alloc_or_throw(n); } catch (...) { return nullptr; }
+}
+void* operator new(std::size_t n, std::align_val_t al) {
+  if (void* p = nhft::aligned_alloc_or_null(n, al)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](std::size_t n, std::align_val_t al) {
+  if (void* p = nhft::aligned_alloc_or_null(n, al)) return p;
+  throw std::bad_alloc();
+}
+void* operator new(std::size_t n, std::align_val_t al, const std::nothrow_t&) noexcept { return nhft::aligned_alloc_or_null(n, al); }
+void* operator new[](std::size_t n, std::align_val_t al, const std::nothrow_t&) noexcept { return nhft::aligned_alloc_or_null(n, al); }
+
+void operator delete(void* p) noexcept { nhft::release(p); }
+void operator delete[](void* p) noexcept { nhft::release(p); }
+void operator delete(void* p, std::size_t) noexcept { nhft::release(p); }
+void operator delete[](void* p, std::size_t) noexcept { nhft::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { nhft::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { nhft::release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { nhft::release(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { nhft::release(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { nhft::release(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { nhft::release(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { nhft::release(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { nhft::release(p); }
+#endif
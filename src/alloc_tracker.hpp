@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+
+namespace nhft {
+
+// Pipeline phase a thread is in; allocations are attributed to the current phase
+enum class AllocPhase : uint8_t { setup = 0, warmup = 1, hot = 2, report = 3 };
+constexpr int kAllocPhases = 4;
+
+struct AllocStats {
+  uint64_t allocs = 0;
+  uint64_t bytes = 0;
+};
+
+// Per-thread counters, indexed by AllocPhase
+struct AllocThreadStats {
+  AllocStats phase[kAllocPhases];
+  uint64_t frees = 0;
+  uint64_t violations = 0; // hot-phase allocations while forbidden
+  const AllocStats& operator[](AllocPhase p) const { return phase[(int)p]; }
+};
+
+// True when built with NANOHFT_ALLOC_TRACKING (global operator new/delete replaced)
+bool alloc_tracking_enabled();
+
+// Phase of the calling thread (setup until changed)
+void alloc_set_phase(AllocPhase p);
+AllocPhase alloc_phase();
+
+// Snapshot of the calling thread's counters; diff two snapshots to scope a region
+AllocThreadStats alloc_thread_stats();
+AllocStats alloc_diff(const AllocThreadStats& before, const AllocThreadStats& after, AllocPhase p);
+
+// Zero-allocation enforcement for the calling thread: every allocation made while
+// it is in AllocPhase::hot counts as a violation, and with log_stack the first few
+// print a backtrace to stderr (glibc only).
+void alloc_forbid_hot(bool on, bool log_stack = true);
+
+} // namespace nhft
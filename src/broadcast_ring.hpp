@@ -0,0 +1,149 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace nhft {
+
+// What the producer does when the slowest consumer is a full ring behind
+enum class Backpressure { drop, block };
+
+// Single-producer / multi-consumer broadcast ring (Disruptor-style).
+// Every consumer sees every event in the same order, reading slots in place.
+// Each consumer owns a cursor; a consumer may depend on other consumers
+// (it only reads slots they have released), and the producer is gated by
+// the slowest consumer so a slot is never overwritten before all have read it.
+template <typename T>
+class BroadcastRing {
+  static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+public:
+  static constexpr int kMaxConsumers = 8;
+  static constexpr int kMaxDeps = 4;
+
+  explicit BroadcastRing(size_t capacity_pow2, Backpressure policy = Backpressure::drop)
+      : capacity_(capacity_pow2), mask_(capacity_pow2 - 1), policy_(policy) {
+    // capacity must be power of two
+    if ((capacity_pow2 & (capacity_pow2 - 1)) != 0) {
+      capacity_ = 1024;
+      mask_ = capacity_ - 1;
+    }
+    buf_.reset(new T[capacity_]()); // value-init touches the pages on the constructing thread's node
+    consumers_.reset(new Cursor[kMaxConsumers]);
+  }
+
+  // Register a consumer while no other thread uses the ring (normally before
+  // publishing starts). deps lists consumers that must release a slot before this
+  // one may read it; empty means gated by the producer only. A consumer added after
+  // publishing started begins at the current head, or at its slowest dependency.
+  // Returns the consumer id, or -1 if the table is full or a dependency is unknown.
+  int add_consumer(std::initializer_list<int> deps = {}) {
+    if (n_consumers_ >= kMaxConsumers || deps.size() > (size_t)kMaxDeps) return -1;
+    Cursor& c = consumers_[n_consumers_];
+    for (int d : deps) {
+      if (d < 0 || d >= n_consumers_) return -1;
+      c.deps[c.n_deps++] = d;
+    }
+    // Start where nothing is readable yet: limit_for(c) never falls below this
+    uint64_t start = head_.load(std::memory_order_relaxed);
+    for (int i = 0; i < c.n_deps; ++i) start = std::min<uint64_t>(start, consumers_[c.deps[i]].seq.load(std::memory_order_relaxed));
+    c.seq.store(start, std::memory_order_relaxed);
+    c.limit_cache = start;
+    return n_consumers_++;
+  }
+
+  // Publish one event to all consumers. Under Backpressure::drop returns false
+  // when the slowest consumer is a full ring behind; under block, spins instead.
+  bool push(const T& v) {
+    auto head = head_.load(std::memory_order_relaxed);
+    if (head - gate_cache_ >= capacity_) {
+      gate_cache_ = slowest();
+      while (head - gate_cache_ >= capacity_) {
+        if (policy_ == Backpressure::drop) return false;
+        std::this_thread::yield();
+        gate_cache_ = slowest();
+      }
+    }
+    buf_[head & mask_] = v;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Zero-copy read: pointer to consumer c's next slot, or nullptr if none is ready.
+  // The slot stays valid until advance(c).
+  const T* peek(int c) {
+    Cursor& cur = consumers_[c];
+    auto seq = cur.seq.load(std::memory_order_relaxed);
+    if (seq == cur.limit_cache) {
+      cur.limit_cache = limit_for(cur);
+      if (seq == cur.limit_cache) return nullptr;
+    }
+    return &buf_[seq & mask_];
+  }
+
+  void advance(int c, uint64_t n = 1) {
+    Cursor& cur = consumers_[c];
+    cur.seq.store(cur.seq.load(std::memory_order_relaxed) + n, std::memory_order_release);
+  }
+
+  // Batch read: invoke f(const T&) on every slot ready for consumer c, then
+  // release them with a single cursor store. Returns the number processed.
+  template <typename F>
+  size_t poll(int c, F&& f) {
+    Cursor& cur = consumers_[c];
+    auto seq = cur.seq.load(std::memory_order_relaxed);
+    auto limit = limit_for(cur);
+    cur.limit_cache = limit;
+    for (auto s = seq; s < limit; ++s) f(static_cast<const T&>(buf_[s & mask_]));
+    if (limit != seq) cur.seq.store(limit, std::memory_order_release);
+    return (size_t)(limit - seq);
+  }
+
+  // Events published but not yet read by consumer c
+  size_t lag(int c) const {
+    return (size_t)(head_.load(std::memory_order_acquire) - consumers_[c].seq.load(std::memory_order_acquire));
+  }
+  // Events published but not yet released by the slowest consumer
+  size_t depth() const { return (size_t)(head_.load(std::memory_order_acquire) - slowest()); }
+
+  uint64_t published() const { return head_.load(std::memory_order_acquire); }
+  size_t capacity() const { return capacity_; }
+  int consumers() const { return n_consumers_; }
+
+private:
+  struct alignas(64) Cursor {
+    std::atomic<uint64_t> seq{0};
+    uint64_t limit_cache = 0; // consumer-private: last known readable bound
+    int deps[kMaxDeps]{};
+    int n_deps = 0;
+  };
+
+  uint64_t limit_for(const Cursor& cur) const {
+    uint64_t limit = head_.load(std::memory_order_acquire);
+    for (int i = 0; i < cur.n_deps; ++i) {
+      limit = std::min<uint64_t>(limit, consumers_[cur.deps[i]].seq.load(std::memory_order_acquire));
+    }
+    return limit;
+  }
+
+  uint64_t slowest() const {
+    uint64_t m = head_.load(std::memory_order_relaxed);
+    for (int i = 0; i < n_consumers_; ++i) m = std::min<uint64_t>(m, consumers_[i].seq.load(std::memory_order_acquire));
+    return m;
+  }
+
+  std::unique_ptr<T[]> buf_;
+  size_t capacity_{};
+  size_t mask_{};
+  Backpressure policy_;
+  std::unique_ptr<Cursor[]> consumers_;
+  int n_consumers_ = 0;
+  alignas(64) std::atomic<uint64_t> head_{0};
+  uint64_t gate_cache_ = 0; // producer-private: last known slowest cursor
+};
+
+} // namespace nhft
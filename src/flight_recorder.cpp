@@ -0,0 +1,140 @@
+#include "flight_recorder.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#endif
+
+namespace nhft {
+
+std::atomic<uint64_t> FlightRecorder::signal_epoch_{0};
+
+void flight_request_snapshot() {
+  FlightRecorder::signal_epoch_.fetch_add(1, std::memory_order_relaxed);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+static void on_flight_signal(int) { flight_request_snapshot(); }
+#endif
+
+bool install_flight_signal_handler() {
+#if defined(__unix__) || defined(__APPLE__)
+  struct sigaction sa{};
+  sa.sa_handler = on_flight_signal;
+  sigemptyset(&sa.sa_mask);
+  sa.sa_flags = SA_RESTART;
+  return sigaction(SIGUSR1, &sa, nullptr) == 0;
+#else
+  return false;
+#endif
+}
+
+static size_t round_up_pow2(size_t n) {
+  size_t c = 1;
+  while (c < n) c <<= 1;
+  return c;
+}
+
+FlightRecorder::FlightRecorder(size_t capacity, uint64_t threshold_ns, std::string out_dir, size_t max_dumps)
+  : threshold_ns_(threshold_ns), out_dir_(std::move(out_dir)), max_dumps_(max_dumps) {
+  if (capacity == 0) return;
+  capacity_ = round_up_pow2(capacity);
+  mask_ = capacity_ - 1;
+  buf_.resize(capacity_);
+  for (auto& s : slots_) s.events.resize(capacity_);
+  seen_epoch_ = signal_epoch_.load(std::memory_order_relaxed);
+  writer_ = std::thread([this]{ writer_loop(); });
+}
+
+FlightRecorder::~FlightRecorder() {
+  if (!enabled()) return;
+  finish();
+  stop_.store(true, std::memory_order_release);
+  cv_.notify_one();
+  writer_.join();
+}
+
+void FlightRecorder::arm(FlightTrigger why, uint64_t seq) {
+  seen_epoch_ = signal_epoch_.load(std::memory_order_relaxed);
+  if (dumps_taken_ >= max_dumps_) return;
+  armed_ = true;
+  trigger_ = why;
+  trigger_seq_ = seq;
+  // Keep recording until the trigger sits in the middle of the window
+  snap_at_ = count_ + capacity_ / 2;
+}
+
+void FlightRecorder::take_snapshot() {
+  armed_ = false;
+  Slot& s = slots_[next_slot_];
+  if (s.state.load(std::memory_order_acquire) != 0) { ++dumps_dropped_; return; }
+  // Copy the ring oldest-first: [head, end) then [0, head)
+  size_t n = (size_t)std::min<uint64_t>(count_, capacity_);
+  size_t head = (size_t)(count_ & mask_);
+  if (n < capacity_) {
+    std::memcpy(s.events.data(), buf_.data(), n * sizeof(FlightEvent));
+  } else {
+    std::memcpy(s.events.data(), buf_.data() + head, (capacity_ - head) * sizeof(FlightEvent));
+    std::memcpy(s.events.data() + (capacity_ - head), buf_.data(), head * sizeof(FlightEvent));
+  }
+  s.count = n;
+  s.index = dumps_taken_++;
+  s.trigger = trigger_;
+  s.trigger_seq = trigger_seq_;
+  s.state.store(1, std::memory_order_release);
+  next_slot_ = (next_slot_ + 1) % 2;
+  cv_.notify_one();
+}
+
+void FlightRecorder::finish() {
+  if (!enabled()) return;
+  if (armed_) take_snapshot();
+  for (auto& s : slots_) {
+    while (s.state.load(std::memory_order_acquire) != 0) {
+      cv_.notify_one();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}
+
+void FlightRecorder::writer_loop() {
+  while (true) {
+    bool idle = true;
+    for (auto& s : slots_) {
+      if (s.state.load(std::memory_order_acquire) == 1) {
+        write_slot(s);
+        s.state.store(0, std::memory_order_release);
+        idle = false;
+      }
+    }
+    if (!idle) continue;
+    if (stop_.load(std::memory_order_acquire)) return;
+    // The consumer never takes the lock; a missed notify costs at most one timeout
+    std::unique_lock<std::mutex> lk(m_);
+    cv_.wait_for(lk, std::chrono::milliseconds(10));
+  }
+}
+
+void FlightRecorder::write_slot(Slot& s) {
+  FlightDumpHeader h{};
+  std::memcpy(h.magic, "NHFTFR1", 8);
+  h.version = 3;
+  h.record_size = sizeof(FlightEvent);
+  h.count = s.count;
+  h.trigger_seq = s.trigger_seq;
+  h.threshold_ns = threshold_ns_;
+  h.trigger = (uint32_t)s.trigger;
+  std::string path = (std::filesystem::path(out_dir_)/("flight_" + std::to_string(s.index) + ".bin")).string();
+  std::ofstream f(path, std::ios::binary);
+  if (!f) { std::cerr << "[warn] flight recorder cannot write " << path << "\n"; return; }
+  f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+  f.write(reinterpret_cast<const char*>(s.events.data()), (std::streamsize)(s.count * sizeof(FlightEvent)));
+  dumps_written_.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace nhft
@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace nhft {
+
+// Risk outcome of one event as seen by the flight recorder
+enum class FlightRisk : uint8_t { none = 0, allowed = 1, per_trade_cap = 2, daily_loss_cap = 3 };
+
+// Why a snapshot was taken
+enum class FlightTrigger : uint32_t { latency = 1, signal = 2 };
+
+// One consumer-loop event; flat POD so recording is a single copy into the ring.
+// Stage times split an outlier into queueing, strategy, risk and routing; a
+// stage the event did not reach is 0, and all of them are 0 in deterministic runs.
+struct FlightEvent {
+  uint64_t seq;         // consumer-side event index
+  uint64_t ts_ns;       // production timestamp
+  uint64_t dequeue_ns;  // consumer picked the event up
+  uint64_t strategy_ns; // strategy decision made
+  uint64_t risk_ns;     // risk check done (decisions only)
+  uint64_t route_ns;    // routed and recorded (allowed orders only)
+  uint64_t done_ns;     // decision + risk + routing complete
+  double score;         // strategy z-score
+  int32_t bid;          // top of book seen by the strategy, in ticks
+  int32_t spread;       // ask - bid, in ticks
+  int32_t symbol;
+  int8_t side;          // -1 sell, 0 hold, +1 buy
+  FlightRisk risk;
+  uint16_t reserved;
+};
+static_assert(std::is_trivially_copyable<FlightEvent>::value, "FlightEvent must be trivially copyable");
+
+// On-disk header of a flight_<n>.bin dump, followed by 'count' FlightEvent records (oldest first)
+struct FlightDumpHeader {
+  char magic[8];          // "NHFTFR1"
+  uint32_t version;       // 3 (2: no stage times, 1: mid as double)
+  uint32_t record_size;   // sizeof(FlightEvent)
+  uint64_t count;
+  uint64_t trigger_seq;   // seq of the event that fired the trigger
+  uint64_t threshold_ns;
+  uint32_t trigger;       // FlightTrigger
+  uint32_t reserved;
+};
+
+// Request a snapshot from every recorder (async-signal-safe)
+void flight_request_snapshot();
+// Route SIGUSR1 to flight_request_snapshot (POSIX only); returns true on success
+bool install_flight_signal_handler();
+
+// Per-thread overwrite ring of the last N events. record() never allocates or locks;
+// when an event exceeds threshold_ns (or a signal arrives) the window around it is
+// copied into a preallocated slot and written to out_dir by a background thread.
+class FlightRecorder {
+public:
+  // capacity is rounded up to a power of two; 0 disables recording.
+  // threshold_ns == 0 disables the latency trigger (signal still works).
+  FlightRecorder(size_t capacity, uint64_t threshold_ns, std::string out_dir, size_t max_dumps = 16);
+  ~FlightRecorder();
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  bool enabled() const { return capacity_ != 0; }
+
+  void record(const FlightEvent& e) {
+    if (capacity_ == 0) return;
+    buf_[count_ & mask_] = e;
+    ++count_;
+    if (armed_) {
+      if (count_ >= snap_at_) take_snapshot();
+      return;
+    }
+    if (threshold_ns_ != 0 && e.done_ns - e.ts_ns > threshold_ns_) arm(FlightTrigger::latency, e.seq);
+    else if (signal_epoch_.load(std::memory_order_relaxed) != seen_epoch_) arm(FlightTrigger::signal, e.seq);
+  }
+
+  // Snapshot any pending window and wait for the writer to drain
+  void finish();
+
+  uint64_t dumps_written() const { return dumps_written_.load(std::memory_order_acquire); }
+  uint64_t dumps_dropped() const { return dumps_dropped_; }
+
+private:
+  struct Slot {
+    std::atomic<int> state{0}; // 0 free, 1 full (owned by writer)
+    std::vector<FlightEvent> events;
+    uint64_t count = 0;
+    uint64_t index = 0;
+    uint64_t trigger_seq = 0;
+    FlightTrigger trigger = FlightTrigger::latency;
+  };
+
+  void arm(FlightTrigger why, uint64_t seq);
+  void take_snapshot();
+  void writer_loop();
+  void write_slot(Slot& s);
+
+  std::vector<FlightEvent> buf_;
+  size_t capacity_ = 0;
+  size_t mask_ = 0;
+  uint64_t count_ = 0;
+  uint64_t threshold_ns_;
+  std::string out_dir_;
+  size_t max_dumps_;
+
+  // trigger state (consumer thread only)
+  bool armed_ = false;
+  uint64_t snap_at_ = 0;
+  uint64_t trigger_seq_ = 0;
+  FlightTrigger trigger_ = FlightTrigger::latency;
+  uint64_t seen_epoch_ = 0;
+  uint64_t dumps_taken_ = 0;
+  uint64_t dumps_dropped_ = 0;
+
+  static std::atomic<uint64_t> signal_epoch_;
+  friend void flight_request_snapshot();
+
+  // background writer
+  Slot slots_[2];
+  size_t next_slot_ = 0;
+  std::atomic<bool> stop_{false};
+  std::atomic<uint64_t> dumps_written_{0};
+  std::mutex m_;
+  std::condition_variable cv_;
+  std::thread writer_;
+};
+
+} // namespace nhft
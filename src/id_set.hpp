@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace nhft {
+
+// Open-addressing set of 64-bit IDs with linear probing. Storage is allocated
+// up front for capacity_pow2 / 2 IDs; inserts below that never touch the
+// allocator. Past half load the set still grows (rehashes) rather than lose
+// IDs, and counts it in grows(): size it for the expected IDs at setup.
+// ID 0 is tracked out of band.
+class IdSet {
+public:
+  explicit IdSet(size_t capacity_pow2 = 1u << 16)
+      : slots_(round_up(capacity_pow2 < 16 ? 16 : capacity_pow2), 0) {}
+
+  // Returns true if id was newly inserted
+  bool insert(uint64_t id) {
+    if (id == 0) { bool fresh = !has_zero_; has_zero_ = true; size_ += fresh; return fresh; }
+    if ((size_ + 1) * 2 > slots_.size()) grow();
+    return insert_slot(slots_, id);
+  }
+
+  bool contains(uint64_t id) const {
+    if (id == 0) return has_zero_;
+    size_t mask = slots_.size() - 1;
+    for (size_t i = mix(id) & mask;; i = (i + 1) & mask) {
+      if (slots_[i] == id) return true;
+      if (slots_[i] == 0) return false;
+    }
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return slots_.size(); }
+  uint64_t grows() const { return grows_; }
+
+private:
+  static size_t round_up(size_t n) { size_t c = 1; while (c < n) c <<= 1; return c; }
+  // Order IDs are FNV hashes already; one multiply spreads sequential test IDs too
+  static size_t mix(uint64_t id) { return (size_t)((id * 0x9E3779B97F4A7C15ull) >> 16); }
+
+  bool insert_slot(std::vector<uint64_t>& slots, uint64_t id) {
+    size_t mask = slots.size() - 1;
+    for (size_t i = mix(id) & mask;; i = (i + 1) & mask) {
+      if (slots[i] == id) return false;
+      if (slots[i] == 0) { slots[i] = id; ++size_; return true; }
+    }
+  }
+
+  void grow() {
+    ++grows_;
+    std::vector<uint64_t> next(slots_.size() * 2, 0);
+    size_t n = size_;
+    for (uint64_t id : slots_) if (id != 0) insert_slot(next, id);
+    size_ = n;
+    slots_.swap(next);
+  }
+
+  std::vector<uint64_t> slots_;
+  size_t size_ = 0;
+  uint64_t grows_ = 0;
+  bool has_zero_ = false;
+};
+
+} // namespace nhft
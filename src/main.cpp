@@ -7,21 +7,30 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <queue>
 #include <random>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 
 #include "util.hpp"
 #include "ringbuf.hpp"
+#include "broadcast_ring.hpp"
 #include "metrics.hpp"
 #include "mdfeed.hpp"
 #include "strategy.hpp"
 #include "risk.hpp"
 #include "router.hpp"
+#include "flight_recorder.hpp"
+#include "snapshot.hpp"
+#include "placement.hpp"
+#include "alloc_tracker.hpp"
+#include "perf_counters.hpp"
+#include "stream_hash.hpp"
 
 using namespace std::chrono;
 
@@ -32,35 +41,87 @@ struct Args {
   int rate = 100000;
   int symbols = 4;
   std::vector<Burst> bursts;
+  FeedConfig feed;         // per-symbol volatility, Zipf popularity, correlation
+  std::vector<double> tick_sizes; // per-symbol tick size; empty = 0.01
   std::string mode = "optimized"; // naive|optimized
   int seed = 7;
-  std::optional<int> affinity;
+  PlacementSpec cpus;      // per-thread CPU placement (feed, engine, shadow, journal)
+  int rt_priority = 0;     // >0: request SCHED_FIFO at this priority for placed threads
   std::string report = "./out/run";
   bool determinism_check = false;
+  int flight_events = 4096;      // flight recorder ring size; 0 disables
+  int flight_threshold_us = 5000; // dump the window around events slower than this; 0 = signal only
+  int shadow_strategies = 0; // extra Strategy consumers on the broadcast ring (optimized mode)
+  bool journal = false;      // journal consumer writing journal.bin behind the primary strategy
+  std::string state_path;    // memory-mapped engine state for warm restarts; empty disables
+  int checkpoint_every = 4096; // events between state checkpoints
+  size_t max_orders = Router::kDefaultMaxOrders; // order IDs tracked without reallocating
+  int warmup_events = 1000;  // events per thread before the hot phase starts
+  bool forbid_hot_allocs = false; // count (and log) engine allocations after warmup; fail the run
+  bool perf_stages = false;  // rdpmc cycle counts around strategy/risk/route (if permitted)
+  int det_runs = 3;          // parallel runs compared by --determinism-check
+  int det_checkpoint_every = 1024; // events between stream-hash checkpoints
+  std::string error;         // set by parse_args on an invalid flag value
 };
 
 static bool parse_burst(const std::string& s, Burst& b) {
-  // format t=10,dur=2,x=5
-  double t=0, dur=0, x=1;
-  if (sscanf(s.c_str(), "t=%lf,dur=%lf,x=%lf", &t, &dur, &x) == 3) { b.t_s=t; b.dur_s=dur; b.x=x; return true; }
+  // format t=10,dur=2,x=5[,corr=0.8]
+  double t=0, dur=0, x=1, corr=-1;
+  int n = sscanf(s.c_str(), "t=%lf,dur=%lf,x=%lf,corr=%lf", &t, &dur, &x, &corr);
+  if (n >= 3) { b.t_s=t; b.dur_s=dur; b.x=x; b.corr=corr; return true; }
   return false;
 }
 
 static Args parse_args(int argc, char** argv) {
   Args a;
+  int affinity = -1;
   for (int i=1;i<argc;++i) {
     std::string arg = argv[i];
     auto next = [&]{ return (i+1<argc)? std::string(argv[++i]) : std::string(); };
     if (arg == "--duration-s") a.duration_s = std::stoi(next());
     else if (arg == "--rate") a.rate = std::stoi(next());
-    else if (arg == "--symbols") a.symbols = std::stoi(next());
+    else if (arg == "--symbols") a.symbols = std::clamp(std::stoi(next()), 1, MdFeed::kMaxSymbols);
     else if (arg == "--burst") { Burst b; if (parse_burst(next(), b)) a.bursts.push_back(b); }
+    else if (arg == "--vol") {
+      // one value for all symbols, or a comma list per symbol
+      std::stringstream ss(next());
+      std::string v;
+      a.feed.vol.clear();
+      while (std::getline(ss, v, ',')) if (!v.empty()) a.feed.vol.push_back(std::stod(v));
+    }
+    else if (arg == "--tick") {
+      std::stringstream ss(next());
+      std::string v;
+      a.tick_sizes.clear();
+      while (std::getline(ss, v, ',')) if (!v.empty()) a.tick_sizes.push_back(std::stod(v));
+    }
+    else if (arg == "--zipf") a.feed.zipf = std::stod(next());
+    else if (arg == "--corr") a.feed.corr = std::stod(next());
     else if (arg == "--mode") a.mode = next();
     else if (arg == "--seed") a.seed = std::stoi(next());
-    else if (arg == "--affinity") { int c = std::stoi(next()); a.affinity = c; }
+    else if (arg == "--affinity") affinity = std::stoi(next());
+    else if (arg == "--cpus") {
+      std::string spec = next();
+      if (!a.cpus.parse(spec)) a.error = "invalid --cpus " + spec + " (expected role=cpu,... with roles " + PlacementSpec::kRoles + ")";
+    }
+    else if (arg == "--rt-priority") a.rt_priority = std::stoi(next());
     else if (arg == "--report") a.report = next();
     else if (arg == "--determinism-check") a.determinism_check = true;
+    else if (arg == "--det-runs") a.det_runs = std::max(2, std::stoi(next()));
+    else if (arg == "--det-checkpoint-every") a.det_checkpoint_every = std::max(1, std::stoi(next()));
+    else if (arg == "--flight-events") a.flight_events = std::stoi(next());
+    else if (arg == "--flight-threshold-us") a.flight_threshold_us = std::stoi(next());
+    else if (arg == "--shadow-strategies") a.shadow_strategies = std::stoi(next());
+    else if (arg == "--journal") a.journal = true;
+    else if (arg == "--state") a.state_path = next();
+    else if (arg == "--warmup-events") a.warmup_events = std::max(0, std::stoi(next()));
+    else if (arg == "--forbid-hot-allocs") a.forbid_hot_allocs = true;
+    else if (arg == "--perf-stages") a.perf_stages = true;
+    else if (arg == "--max-orders") a.max_orders = (size_t)std::max(1LL, std::stoll(next()));
+    else if (arg == "--checkpoint-every") a.checkpoint_every = std::max(1, std::stoi(next()));
   }
+  // Applied last so it wins over an engine entry in --cpus, whatever the flag order
+  if (affinity >= 0) a.cpus.set("engine", affinity);
   return a;
 }
 
@@ -85,30 +146,55 @@ static inline double rate_with_bursts(int base_rate, double t, const std::vector
   return r;
 }
 
-static EngineResult run_engine(const Args& args, bool deterministic_timing=false) {
+// stream: if set, every processed event is folded into it (determinism checks).
+// write_artifacts: false skips every file under args.report (parallel check runs).
+static EngineResult run_engine(const Args& args, bool deterministic_timing=false, StreamHasher* stream=nullptr, bool write_artifacts=true) {
   namespace fs = std::filesystem;
-  fs::create_directories(args.report);
+  auto boot_tp = steady_clock::now();
+  if (write_artifacts) fs::create_directories(args.report);
 
-  Metrics m; m.seed=args.seed; m.code_hash=code_hash(); m.symbols=args.symbols; m.rate=args.rate; m.mode=args.mode; m.rss_mb = deterministic_timing ? 0.0 : rss_mb();
+  Metrics m; m.allocs.tracking = alloc_tracking_enabled(); m.seed=args.seed; m.code_hash=code_hash(); m.symbols=args.symbols; m.rate=args.rate; m.mode=args.mode; m.rss_mb = deterministic_timing ? 0.0 : rss_mb();
   LatencyRecorder& lat = m.latency;
 
-  if (args.affinity) pin_to_cpu(*args.affinity);
+  // Threads pin themselves on start; meanwhile allocate engine state from the
+  // engine CPU so first-touch places rings and state on its NUMA node
+  PlacementLog placements;
+  auto place = [&](const char* role, int idx, std::string label){
+    if (!deterministic_timing) placements.add(place_current_thread(label, args.cpus.cpu_for(role, idx), args.rt_priority));
+  };
+  // Flight recorder lives on the consumer loop; dumps land next to the other artifacts.
+  // Built before the engine binding: its writer thread must not inherit the engine's CPU mask.
+  FlightRecorder flight(write_artifacts ? (size_t)std::max(0, args.flight_events) : 0, (uint64_t)std::max(0, args.flight_threshold_us) * 1000ull, args.report);
+
+  std::optional<ScopedCpuBinding> numa_bind;
+  if (!deterministic_timing) numa_bind.emplace(args.cpus.cpu_for("engine"));
 
   const int S = args.symbols;
-  MdFeed feed(S, args.rate, args.seed, args.bursts, deterministic_timing);
+  TickTable ticks(S, args.tick_sizes);
+  MdFeed feed(S, args.rate, args.seed, args.bursts, deterministic_timing, args.feed, &ticks);
   Strategy strat(S);
-  Risk risk(S);
+  Risk risk(ticks);
 
   // Trades CSV path
-  std::string trades_csv = (fs::path(args.report)/"trades.csv").string();
-  Router router(args.seed, trades_csv);
+  std::string trades_csv = write_artifacts ? (fs::path(args.report)/"trades.csv").string() : std::string();
+  Router router(args.seed, trades_csv, ticks, args.max_orders);
+
+  // Warm restart: remap the state file and resume from its newest valid checkpoint
+  StateFile state;
+  EngineCursor cursor;
+  if (!args.state_path.empty() && state.open(args.state_path, ticks, args.max_orders)) {
+    auto r0 = steady_clock::now();
+    m.startup.warm = state.restore(strat, risk, router, cursor);
+    m.startup.resumed_events = cursor.events;
+    if (!deterministic_timing) m.startup.restore_ms = duration<double, std::milli>(steady_clock::now() - r0).count();
+  }
 
   // Queues
   struct Payload { MdEvent ev; };
   std::atomic<bool> done{false};
   std::atomic<uint64_t> drops{0};
   std::atomic<uint64_t> processed{0};
-  std::atomic<uint64_t> seq{0};
+  std::atomic<uint64_t> seq{cursor.order_seq};
   std::atomic<uint64_t> depth_max{0};
 
   auto start_tp = steady_clock::now();
@@ -121,15 +207,38 @@ static EngineResult run_engine(const Args& args, bool deterministic_timing=false
   // Optimized ring
   SpscRing<Payload> ring(1u<<14);
 
+  // Broadcast ring replaces the SPSC ring when more than one consumer reads the feed:
+  // the primary pipeline, shadow strategies, and a journal gated on the primary
+  const int shadows = std::clamp(args.shadow_strategies, 0, BroadcastRing<Payload>::kMaxConsumers - 2);
+  const bool broadcast = args.mode != "naive" && (shadows > 0 || args.journal);
+  std::unique_ptr<BroadcastRing<Payload>> bring;
+  int primary_id = -1, journal_id = -1;
+  std::vector<int> shadow_ids;
+  if (broadcast) {
+    bring = std::make_unique<BroadcastRing<Payload>>(1u<<14, deterministic_timing ? Backpressure::block : Backpressure::drop);
+    primary_id = bring->add_consumer();
+    for (int i=0;i<shadows;++i) shadow_ids.push_back(bring->add_consumer());
+    if (args.journal) journal_id = bring->add_consumer({primary_id});
+  }
+  m.consumers.decisions.assign(1 + shadows, 0);
+  numa_bind.reset();
+
   auto producer = [&](){
+    place("feed", 0, "feed");
+    auto a0 = alloc_thread_stats();
+    AllocPhase prev_phase = alloc_phase();
+    alloc_set_phase(args.warmup_events > 0 ? AllocPhase::warmup : AllocPhase::hot);
+    uint64_t produced = 0;
     auto now = start_tp;
     double t = 0.0;
     while (now < end_tp) {
+      if (++produced == (uint64_t)args.warmup_events + 1) alloc_set_phase(AllocPhase::hot);
       double r = rate_with_bursts(args.rate, t, args.bursts);
       double period_ns = 1e9 / std::max(1.0, r);
       // produce one event per loop iteration
       MdEvent ev = feed.next(t);
-      ev.ts_ns = to_ns(now);
+      // Deterministic runs stamp simulated time since start so timestamps replay exactly
+      ev.ts_ns = deterministic_timing ? (uint64_t)duration_cast<nanoseconds>(now - start_tp).count() : to_ns(now);
       Payload p{ev};
       bool pushed=false;
       if (args.mode == "naive") {
@@ -137,8 +246,15 @@ static EngineResult run_engine(const Args& args, bool deterministic_timing=false
         naive_q.push(p);
         pushed = true; // naive is unbounded (intentional), no drop here
       } else {
-        pushed = ring.push(p);
-        if (!pushed) drops++; else depth_max.store(std::max(depth_max.load(), (uint64_t)ring.depth()));
+        pushed = broadcast ? bring->push(p) : ring.push(p);
+        if (deterministic_timing) {
+          // Deterministic runs never drop: wait for the consumer, so the stream
+          // covers the whole duration whatever the thread interleaving
+          while (!pushed) { std::this_thread::yield(); pushed = broadcast ? bring->push(p) : ring.push(p); }
+        } else {
+          size_t depth = broadcast ? bring->depth() : ring.depth();
+          if (!pushed) drops++; else depth_max.store(std::max(depth_max.load(), (uint64_t)depth));
+        }
       }
       // Next schedule
       if (deterministic_timing) {
@@ -153,42 +269,90 @@ static EngineResult run_engine(const Args& args, bool deterministic_timing=false
       }
     }
     done.store(true);
+    auto a1 = alloc_thread_stats();
+    alloc_set_phase(prev_phase);
+    auto w = alloc_diff(a0, a1, AllocPhase::warmup), h = alloc_diff(a0, a1, AllocPhase::hot);
+    m.allocs.feed_warmup = {w.allocs, w.bytes};
+    m.allocs.feed_hot = {h.allocs, h.bytes};
   };
 
   auto consumer = [&](){
+    place("engine", 0, "engine");
+    auto a0 = alloc_thread_stats();
+    AllocPhase prev_phase = alloc_phase();
+    alloc_set_phase(args.warmup_events > 0 ? AllocPhase::warmup : AllocPhase::hot);
+    if (args.forbid_hot_allocs) alloc_forbid_hot(true);
+    // Counter values are host-dependent, so deterministic runs leave them out
+    PerfCounters pc;
+    const bool perf_on = !deterministic_timing && pc.open();
+    const bool stages = perf_on && args.perf_stages && pc.has_rdpmc();
+    uint64_t stage_cycles[3] = {0, 0, 0};
+    // Per-stage wall times for the flight recorder; host-dependent like the counters
+    const bool flight_stages = flight.enabled() && !deterministic_timing;
+    auto stage_ns = [&]{ return flight_stages ? to_ns(steady_clock::now()) : 0; };
+    if (perf_on) pc.start();
     OrderKey key{(uint64_t)args.seed, 0, 0, 0};
-    while (!done.load() || (args.mode=="naive" ? !naive_q.empty() : ring.depth()>0)) {
+    char reason[8];
+    auto pending = [&]{
+      if (args.mode == "naive") return !naive_q.empty();
+      return broadcast ? bring->lag(primary_id) > 0 : ring.depth() > 0;
+    };
+    while (!done.load() || pending()) {
       Payload p{};
       bool got=false;
       if (args.mode == "naive") {
         std::lock_guard<std::mutex> lk(naive_m);
         if (!naive_q.empty()) { p = naive_q.front(); naive_q.pop(); got=true; }
+      } else if (broadcast) {
+        if (const Payload* slot = bring->peek(primary_id)) { p = *slot; bring->advance(primary_id); got=true; }
       } else {
         got = ring.pop(p);
       }
       if (!got) {
-        if (!deterministic_timing) std::this_thread::yield();
+        std::this_thread::yield();
         continue;
       }
 
       auto t0_ns = p.ev.ts_ns;
+      uint64_t deq_ns = stage_ns(), strat_ns = 0, risk_ns = 0, route_ns = 0;
+      uint64_t c0 = stages ? pc.rdpmc_cycles() : 0;
       // Strategy decision
       // Naive mode intentionally allocates in hot path to create tails
-      Decision d = strat.on_mid(p.ev.symbol, p.ev.mid);
+      Decision d = strat.on_mid(p.ev.symbol, p.ev.mid2());
+      if (processed.load(std::memory_order_relaxed) == 0 && !deterministic_timing) {
+        m.startup.ttfd_ms = duration<double, std::milli>(steady_clock::now() - boot_tp).count();
+      }
       if (args.mode == "naive") {
         // allocation and string manipulation as an intentional penalty
-        std::string tmp = std::to_string(d.reason_score);
+        // (longer than the small-string buffer so it really reaches the heap)
+        std::string tmp = "reason_score=" + std::to_string(d.reason_score);
         if (tmp.size() > 1000000) std::cerr << "never"; // keep compiler from optimizing away
       }
 
+      strat_ns = stage_ns();
+      FlightRisk fr = FlightRisk::none;
+      int filled = 0;
+      uint64_t c1 = stages ? pc.rdpmc_cycles() : 0;
+      if (stages) stage_cycles[0] += c1 - c0;
       if (d.side != 0) {
-        // Risk check
-        auto riskr = risk.check(p.ev.symbol, d.side, d.qty, p.ev.mid);
+        m.consumers.decisions[0]++;
+        // Risk check at the price the IOC would fill
+        int64_t px = Router::ioc_price(d.side, p.ev.bid, p.ev.ask());
+        auto riskr = risk.check(p.ev.symbol, d.side, d.qty, px);
+        fr = (FlightRisk)(1 + (int)riskr.code);
+        risk_ns = stage_ns();
+        uint64_t c2 = stages ? pc.rdpmc_cycles() : 0;
+        if (stages) stage_cycles[1] += c2 - c1;
         if (riskr.allowed) {
           key.sym = p.ev.symbol; key.seq = ++seq; key.side = d.side;
           uint64_t oid = make_order_id(key);
-          router.ioc_fill(oid, p.ev.ts_ns, p.ev.symbol, d.side, d.qty, p.ev.mid, p.ev.spread*0.5, std::to_string(d.reason_score).substr(0,6));
-          risk.on_fill(p.ev.symbol, d.side, d.qty, p.ev.mid);
+          int n = std::snprintf(reason, sizeof(reason), "%f", d.reason_score); // 6-char score excerpt, no heap
+          router.ioc_fill(oid, p.ev.ts_ns, p.ev.symbol, d.side, d.qty, px, std::string_view(reason, (size_t)std::clamp(n, 0, 6)));
+          risk.on_fill(p.ev.symbol, d.side, d.qty, px);
+          state.record_fill(oid, key.seq, p.ev.symbol, d.side, d.qty, px);
+          filled = 1;
+          route_ns = stage_ns();
+          if (stages) stage_cycles[2] += pc.rdpmc_cycles() - c2;
         } else {
           // blocked
         }
@@ -196,20 +360,86 @@ static EngineResult run_engine(const Args& args, bool deterministic_timing=false
       auto t1 = deterministic_timing ? (t0_ns + 1000) : to_ns(steady_clock::now());
       double ms = ns_to_ms(t1 - t0_ns);
       lat.add_sample(ms);
+      flight.record(FlightEvent{processed.load(std::memory_order_relaxed), t0_ns, deq_ns, strat_ns, risk_ns, route_ns, t1,
+                                d.reason_score, p.ev.bid, p.ev.spread, p.ev.symbol, (int8_t)d.side, fr, 0});
+      if (stream) stream->on_event(StreamEvent{processed.load(std::memory_order_relaxed), t0_ns, p.ev.symbol, d.side, p.ev.mid2(), d.reason_score, (int32_t)fr, filled, risk.pnl()});
       processed++;
+      if (processed.load(std::memory_order_relaxed) == (uint64_t)args.warmup_events) alloc_set_phase(AllocPhase::hot);
+      if (state.is_open() && processed.load(std::memory_order_relaxed) % (uint64_t)args.checkpoint_every == 0) {
+        state.checkpoint(strat, risk, EngineCursor{cursor.events + processed.load(std::memory_order_relaxed), seq.load()});
+      }
       m.reliability.queue_depth_max = std::max<uint64_t>(m.reliability.queue_depth_max, depth_max.load());
     }
+    if (stream) stream->finish();
+    if (perf_on) {
+      pc.stop();
+      m.perf.available = true;
+      m.perf.rdpmc = stages;
+      m.perf.events = processed.load();
+      m.perf.totals = pc.read();
+      for (int i=0;i<3;++i) m.perf.stage_cycles[i] = stage_cycles[i];
+    }
+    auto a1 = alloc_thread_stats();
+    alloc_forbid_hot(false);
+    alloc_set_phase(prev_phase);
+    auto w = alloc_diff(a0, a1, AllocPhase::warmup), h = alloc_diff(a0, a1, AllocPhase::hot);
+    m.allocs.engine_warmup = {w.allocs, w.bytes};
+    m.allocs.engine_hot = {h.allocs, h.bytes};
+    m.allocs.hot_events = processed.load() > (uint64_t)args.warmup_events ? processed.load() - args.warmup_events : 0;
+    m.allocs.forbid_violations = a1.violations - a0.violations;
   };
 
-  if (deterministic_timing) {
-    // Single-threaded deterministic simulation
-    producer();
-    consumer();
-  } else {
+  // Shadow strategies read the same slots in place and only count decisions
+  auto shadow = [&](int k){
+    place("shadow", k, "shadow" + std::to_string(k));
+    Strategy s(S);
+    int id = shadow_ids[k];
+    uint64_t n = 0;
+    while (!done.load() || bring->lag(id) > 0) {
+      size_t got = bring->poll(id, [&](const Payload& p){ if (s.on_mid(p.ev.symbol, p.ev.mid2()).side != 0) ++n; });
+      if (!got) std::this_thread::yield();
+    }
+    m.consumers.decisions[1 + k] = n;
+  };
+
+  // Journal trails the primary consumer and appends raw events to journal.bin
+  auto journal = [&](){
+    place("journal", 0, "journal");
+    std::ofstream f;
+    if (write_artifacts) f.open((fs::path(args.report)/"journal.bin").string(), std::ios::binary);
+    uint64_t n = 0;
+    while (!done.load() || bring->lag(journal_id) > 0) {
+      size_t got = bring->poll(journal_id, [&](const Payload& p){ f.write(reinterpret_cast<const char*>(&p.ev), sizeof(MdEvent)); });
+      n += got;
+      if (!got) std::this_thread::yield();
+    }
+    m.consumers.journal_events = n;
+  };
+
+  // Deterministic runs use the same threads: the producer blocks instead of
+  // dropping and depth is not recorded, so results do not depend on scheduling
+  {
     std::thread pt(producer);
     std::thread ct(consumer);
+    std::vector<std::thread> st;
+    for (int k=0;k<shadows;++k) st.emplace_back(shadow, k);
+    std::thread jt;
+    if (journal_id >= 0) jt = std::thread(journal);
     pt.join();
     ct.join();
+    for (auto& t : st) t.join();
+    if (jt.joinable()) jt.join();
+  }
+  flight.finish();
+  if (state.is_open()) {
+    state.checkpoint(strat, risk, EngineCursor{cursor.events + processed.load(), seq.load()});
+    m.startup.checkpoints = state.checkpoints();
+    m.startup.log_dropped = state.log_dropped();
+    if (state.log_dropped() > 0) {
+      std::cerr << "[warn] state file order log full: " << state.log_dropped()
+                << " fills not logged; the next start will be cold (raise --max-orders)\n";
+    }
+    state.close();
   }
 
   // Throughput: processed / elapsed
@@ -217,17 +447,25 @@ static EngineResult run_engine(const Args& args, bool deterministic_timing=false
   m.eps = processed / std::max(1.0, elapsed_s);
   m.reliability.drops = drops.load();
   m.reliability.idempotency_violations = router.idempotency_violations();
+  m.reliability.order_set_grows = router.id_set_grows();
   m.reliability.exposure_blocks = risk.exposure_blocks();
   if (!deterministic_timing) m.rss_mb = rss_mb(); else m.rss_mb = 0.0;
 
+  std::string json = m.to_json();
+  if (!write_artifacts) return EngineResult{m, json};
+
   // Artifacts
   std::ofstream f_json((std::filesystem::path(args.report)/"metrics.json").string());
-  std::string json = m.to_json();
   f_json << json << std::endl;
   std::ofstream f_lat((std::filesystem::path(args.report)/"latency.csv").string());
   f_lat << lat.csv_samples_header() << "\n" << lat.csv_samples();
   std::ofstream f_fp((std::filesystem::path(args.report)/"run_fingerprint.txt").string());
   f_fp << "seed=" << args.seed << "\ncode_hash=" << code_hash() << "\nsymbols=" << args.symbols << "\nrate=" << args.rate << "\nmode=" << args.mode << "\n";
+  f_fp << "flight_events=" << args.flight_events << "\nflight_threshold_us=" << args.flight_threshold_us
+       << "\nflight_dumps=" << flight.dumps_written() << "\nflight_dumps_dropped=" << flight.dumps_dropped() << "\n";
+  f_fp << "cpus=";
+  for (size_t i=0;i<args.cpus.entries.size();++i) f_fp << (i?",":"") << args.cpus.entries[i].first << "=" << args.cpus.entries[i].second;
+  f_fp << "\nrt_priority=" << args.rt_priority << "\n" << placements.fingerprint();
   std::ofstream f_md((std::filesystem::path(args.report)/"report.md").string());
   f_md << "Run report\n\n" << json << "\n";
 
@@ -235,20 +473,78 @@ static EngineResult run_engine(const Args& args, bool deterministic_timing=false
   return er;
 }
 
+// Runs the engine det_runs times in parallel under deterministic timing. Each run
+// folds its event/decision/fill stream into a rolling hash with periodic
+// checkpoints; only run0 writes artifacts. On a mismatch the first diverging
+// checkpoint window is rerun with per-event capture to name the exact event.
 static int determinism_check(const Args& args) {
   namespace fs = std::filesystem;
   fs::create_directories(args.report);
-  std::vector<uint64_t> sums;
-  for (int i=0;i<3;++i) {
-    std::string run_dir = (fs::path(args.report)/("run"+std::to_string(i))).string();
-    Args a = args; a.report = run_dir;
-    auto er = run_engine(a, /*deterministic_timing=*/true);
-    uint64_t sum = fnv1a64_str(er.metrics_json);
-    sums.push_back(sum);
+  const int n = std::max(2, args.det_runs);
+  const uint64_t every = (uint64_t)std::max(1, args.det_checkpoint_every);
+
+  auto run_all = [&](const std::vector<int>& ids, std::vector<StreamHasher>& streams, std::vector<uint64_t>* sums) {
+    std::vector<std::thread> threads;
+    for (size_t k=0;k<ids.size();++k) {
+      threads.emplace_back([&, k]{
+        int id = ids[k];
+        Args a = args;
+        a.report = (fs::path(args.report)/("run"+std::to_string(id))).string();
+        a.state_path.clear(); // runs must not resume from each other
+        bool artifacts = sums && id == 0;
+        auto er = run_engine(a, /*deterministic_timing=*/true, &streams[k], artifacts);
+        if (sums) (*sums)[k] = fnv1a64_str(er.metrics_json);
+      });
+    }
+    for (auto& t : threads) t.join();
+  };
+
+  std::vector<int> ids(n);
+  for (int i=0;i<n;++i) ids[i] = i;
+  std::vector<StreamHasher> streams(n, StreamHasher(every));
+  std::vector<uint64_t> sums(n);
+  run_all(ids, streams, &sums);
+
+  // Earliest divergence from run0 across all runs
+  bool pass = true;
+  int bad = -1;
+  DivergenceWindow win;
+  for (int i=1;i<n;++i) {
+    if (sums[i] == sums[0] && streams[i].hash() == streams[0].hash()) continue;
+    pass = false;
+    auto w = first_divergent_window(streams[0], streams[i]);
+    if (bad < 0 || (w.found && (!win.found || w.begin < win.begin))) { bad = i; win = w; }
   }
-  bool pass = (sums[0]==sums[1] && sums[1]==sums[2]);
+
+  std::ostringstream div;
+  if (pass) {
+    div << "null";
+  } else if (!win.found) {
+    // Streams agree; only the aggregate metrics differ
+    div << "{ \"run\": " << bad << ", \"window\": null }";
+  } else {
+    std::vector<StreamHasher> rerun(2, StreamHasher(every, win.begin, win.end));
+    run_all({0, bad}, rerun, nullptr);
+    long at = first_divergent_event(rerun[0], rerun[1]);
+    div << "{ \"run\": " << bad << ", \"window\": [" << win.begin << ", " << win.end << "], \"reproduced\": " << (at >= 0 ? "true" : "false");
+    if (at >= 0) {
+      auto& c0 = rerun[0].captured();
+      auto& c1 = rerun[1].captured();
+      div << ", \"event\": " << (win.begin + (uint64_t)at)
+          << ", \"reference\": " << ((size_t)at < c0.size() ? stream_event_json(c0[at].ev) : std::string("null"))
+          << ", \"candidate\": " << ((size_t)at < c1.size() ? stream_event_json(c1[at].ev) : std::string("null"));
+    }
+    div << " }";
+  }
+
   std::ofstream f((fs::path(args.report)/"determinism_result.json").string());
-  f << "{ \"pass\": " << (pass?"true":"false") << ", \"runs\": [" << sums[0] << ", " << sums[1] << ", " << sums[2] << "] }\n";
+  f << "{ \"pass\": " << (pass?"true":"false") << ", \"runs\": [";
+  for (int i=0;i<n;++i) f << (i?", ":"") << sums[i];
+  f << "], \"stream\": [";
+  for (int i=0;i<n;++i) f << (i?", ":"") << streams[i].hash();
+  f << "], \"events\": " << streams[0].events() << ", \"checkpoint_every\": " << every
+    << ", \"divergence\": " << div.str() << " }\n";
+  if (!pass) std::cerr << "[warn] determinism check failed: " << div.str() << "\n";
   return pass ? 0 : 1;
 }
 
@@ -257,11 +553,19 @@ static int determinism_check(const Args& args) {
 int main(int argc, char** argv) {
   using namespace nhft;
   auto args = parse_args(argc, argv);
+  if (!args.error.empty()) {
+    std::cerr << "[error] " << args.error << "\n";
+    return 2;
+  }
   std::filesystem::create_directories(args.report);
+  install_flight_signal_handler();
   if (args.determinism_check) {
     return determinism_check(args);
   }
   auto er = run_engine(args, /*deterministic_timing=*/false);
-  (void)er;
+  if (args.forbid_hot_allocs && er.metrics.allocs.forbid_violations > 0) {
+    std::cerr << "[error] " << er.metrics.allocs.forbid_violations << " allocations on the engine hot path after warmup\n";
+    return 3;
+  }
   return 0;
 }
@@ -1,35 +1,151 @@
 #include "mdfeed.hpp"
 #include <cmath>
+#include <limits>
 
 namespace nhft {
 
-MdFeed::MdFeed(int symbols, int rate_eps, uint64_t seed, const std::vector<Burst>& bursts, bool deterministic_timing)
-  : S_(symbols), rate_(rate_eps), seed_(seed), bursts_(bursts), rng_(seed) {
+MdFeed::MdFeed(int symbols, int rate_eps, uint64_t seed, const std::vector<Burst>& bursts, bool deterministic_timing,
+               const FeedConfig& cfg, const TickTable* ticks)
+  : S_(std::clamp(symbols, 1, kMaxSymbols)), rate_(rate_eps), seed_(seed), bursts_(bursts), rng_(seed) {
   (void)deterministic_timing;
+  // The walk runs directly on each symbol's tick scale
   mids_.resize(S_);
-  for (int i=0;i<S_;++i) mids_[i] = 100.0 + i; // simple ladder of prices
+  for (int i=0;i<S_;++i) {
+    double tick = ticks && i < ticks->symbols() ? ticks->tick_size(i) : TickTable::kDefaultTick;
+    mids_[i] = (100.0 + i) / tick; // simple ladder of prices
+  }
+  vol_.assign(S_, cfg.vol.empty() ? 0.01 : cfg.vol.back());
+  for (size_t i=0;i<cfg.vol.size() && i<(size_t)S_;++i) vol_[i] = cfg.vol[i];
+  corr_ = std::clamp(cfg.corr, 0.0, 1.0);
+  factor_on_ = corr_ > 0.0;
+  for (auto& b : bursts_) factor_on_ = factor_on_ || b.corr > 0.0;
+
+  // Zipf popularity through a Vose alias table: O(1) per draw, two random words
+  zipf_ = cfg.zipf > 0.0 && S_ > 1;
+  if (zipf_) {
+    std::vector<double> p(S_);
+    double sum = 0.0;
+    for (int k=0;k<S_;++k) sum += (p[k] = 1.0 / std::pow(k + 1.0, cfg.zipf));
+    for (auto& x : p) x = x * S_ / sum;
+    alias_thr_.assign(S_, 0);
+    alias_.resize(S_);
+    std::vector<int> small, large;
+    for (int k=0;k<S_;++k) (p[k] < 1.0 ? small : large).push_back(k);
+    while (!small.empty() && !large.empty()) {
+      int s = small.back(); small.pop_back();
+      int l = large.back();
+      alias_thr_[s] = (uint32_t)std::lround(p[s] * 65536.0);
+      alias_[s] = l;
+      p[l] -= 1.0 - p[s];
+      if (p[l] < 1.0) { large.pop_back(); small.push_back(l); }
+    }
+    // Leftovers are full columns (up to rounding): always keep
+    for (int k : large) { alias_thr_[k] = 65536; alias_[k] = k; }
+    for (int k : small) { alias_thr_[k] = 65536; alias_[k] = k; }
+  }
+
 }
 
-static inline double rate_with_bursts(int base_rate, double t, const std::vector<Burst>& bursts) {
-  double r = base_rate;
-  for (auto& b : bursts) {
-    if (t >= b.t_s && t < (b.t_s + b.dur_s)) r *= b.x;
+void MdFeed::update_corr(double now_s) {
+  // Find the correlation at now_s and the widest interval around it on which no
+  // correlated burst starts or ends, so next() only comes back at an edge
+  double rho = -1.0;
+  double lo = -std::numeric_limits<double>::infinity(), hi = std::numeric_limits<double>::infinity();
+  for (auto& b : bursts_) {
+    if (b.corr < 0.0) continue;
+    double end = b.t_s + b.dur_s;
+    if (now_s < b.t_s) {
+      hi = std::min(hi, b.t_s);
+    } else if (now_s < end) {
+      lo = std::max(lo, b.t_s);
+      hi = std::min(hi, end);
+      if (rho < 0.0) rho = std::min(1.0, b.corr); // the first matching burst wins
+    } else {
+      lo = std::max(lo, end);
+    }
   }
-  return r;
+  if (rho < 0.0) rho = corr_;
+  corr_lo_ = lo;
+  corr_hi_ = hi;
+  double a = std::sqrt(1.0 - rho), b = std::sqrt(rho);
+  if (a == a_ && b == b_) return;
+  a_ = a;
+  b_ = b;
+  mix(pos_); // the rest of the buffer moves at the new correlation
 }
 
-MdEvent MdFeed::next(double now_s) {
-  // Choose symbol round-robin; per-instance cycling for determinism
-  sym_idx_ = (sym_idx_ + 1) % S_;
-  // Random walk on mid
-  std::uniform_real_distribution<double> u(-0.01, 0.01);
-  mids_[sym_idx_] = std::max(0.01, mids_[sym_idx_] * (1.0 + u(rng_)));
-  MdEvent ev{};
-  ev.symbol = sym_idx_;
-  ev.mid = mids_[sym_idx_];
-  ev.spread = 0.01; // constant 1c for simplicity
-  ev.ts_ns = (uint64_t)std::llround(now_s * 1e9);
-  return ev;
+void MdFeed::refill() {
+  // Vectorized Philox on stream 0. Under zipf event e uses words 2e (symbol)
+  // and 2e+1 (idiosyncratic move); round-robin needs only the move, word e.
+  uint32_t mw[kBatch]; // move word per event
+  if (zipf_) {
+    uint32_t w[2 * kBatch];
+    rng_.fill(base_ / 2, 0, w, kBatch / 2);
+    for (size_t i=0;i<kBatch;++i) {
+      // Column from the high bits, 16-bit coin from the low bits
+      uint32_t col = rng_below(w[2*i], (uint32_t)S_);
+      int alt = alias_[col];
+      int keep = -(int)((w[2*i] & 0xFFFFu) < alias_thr_[col]); // branch-free: the coin is unpredictable
+      sym_[i] = (uint16_t)(alt ^ (((int)col ^ alt) & keep));
+      mw[i] = w[2*i + 1];
+    }
+  } else {
+    rng_.fill(base_ / 4, 0, mw, kBatch / 4);
+    // In runs up to the wrap, so each run is a plain (vectorizable) iota
+    int rr = sym_idx_ + 1 == S_ ? 0 : sym_idx_ + 1;
+    for (size_t i=0;i<kBatch;) {
+      const size_t run = std::min(kBatch - i, (size_t)(S_ - rr));
+      for (size_t k=0;k<run;++k) sym_[i + k] = (uint16_t)(rr + (int)k);
+      i += run;
+      rr += (int)run;
+      if (rr == S_) rr = 0;
+    }
+    sym_idx_ = rr == 0 ? S_ - 1 : rr - 1;
+  }
+  // Market factor for correlated moves: keyed by absolute event index / kFactorTick
+  // on its own Philox stream, so batch boundaries never change the output
+  constexpr size_t kGroups = kBatch / kFactorTick;
+  if (factor_on_) {
+    uint32_t f[4 * kGroups];
+    rng_.fill(base_ / kFactorTick, 1, f, kGroups);
+    for (size_t g=0;g<kGroups;++g) factor_[g] = rng_signed_unit(f[4 * g]);
+  }
+  // Idiosyncratic moves, mixed in the same pass (as mix(0) would)
+  const double a = a_, b = b_;
+  for (size_t i=0;i<kBatch;i+=kFactorTick) {
+    const double f = b * factor_[i / kFactorTick];
+    for (size_t k=i;k<i + kFactorTick;++k) {
+      idio_[k] = rng_signed_unit(mw[k]);
+      move_[k] = a * idio_[k] + f;
+    }
+  }
+  base_ += kBatch;
+  pos_ = 0;
+}
+
+void MdFeed::mix(size_t from) {
+  // Per factor group so the inner loop is a plain vectorizable multiply-add
+  const double a = a_, b = b_;
+  for (size_t i=from;i<kBatch;) {
+    const size_t end = (i / kFactorTick + 1) * kFactorTick;
+    const double f = b * factor_[i / kFactorTick];
+    for (;i<end;++i) move_[i] = a * idio_[i] + f;
+  }
+}
+
+void MdFeed::next_batch(double now_s, MdEvent* out, size_t n) {
+  if (now_s < corr_lo_ || now_s >= corr_hi_) update_corr(now_s);
+  const uint64_t ts = stamp(now_s);
+  while (n > 0) {
+    if (pos_ == kBatch) refill();
+    size_t m = std::min(n, kBatch - pos_);
+    // Scalar walk: the symbol-indexed loads would otherwise become vector
+    // gathers, which are slower than scalar loads on many cores
+    for (size_t i=0;i<m;++i) out[i] = step(pos_ + i, ts);
+    pos_ += m;
+    out += m;
+    n -= m;
+  }
 }
 
 } // namespace nhft
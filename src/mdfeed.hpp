@@ -1,35 +1,102 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
-#include <random>
 #include <string>
+#include "price.hpp"
+#include "rng.hpp"
 
 namespace nhft {
 
+// Top of book, packed to 16 bytes (four events per cache line). Prices are in
+// ticks of the symbol; see TickTable for the conversion.
 struct MdEvent {
-  uint64_t ts_ns; // production timestamp
-  int symbol;     // 0..S-1
-  double mid;     // mid price
-  double spread;  // spread
+  uint64_t ts_ns;  // production timestamp
+  Ticks bid;
+  uint16_t symbol; // 0..S-1
+  uint16_t spread; // ask - bid, in ticks
+  Ticks ask() const { return bid + spread; }
+  int64_t mid2() const { return 2 * (int64_t)bid + spread; } // mid in half-ticks, exact
 };
+static_assert(sizeof(MdEvent) == 16, "MdEvent must stay 16 bytes");
 
-struct Burst { double t_s=0; double dur_s=0; double x=1; };
+// corr >= 0 overrides FeedConfig::corr inside the burst (correlated burst)
+struct Burst { double t_s=0; double dur_s=0; double x=1; double corr=-1; };
+
+struct FeedConfig {
+  // Relative move scale per event, per symbol; one value applies to all; empty = 0.01.
+  // With corr = 0 a move is uniform in [-vol, vol). A shared factor keeps the
+  // variance but mixes two draws, so moves reach up to vol * (sqrt(1-corr) + sqrt(corr)).
+  std::vector<double> vol;
+  double zipf = 0.0;       // symbol popularity exponent (p_k ~ 1/(k+1)^zipf); 0 = round-robin
+  double corr = 0.0;       // correlation of moves with a shared market factor, 0..1
+};
 
 class MdFeed {
 public:
-  MdFeed(int symbols, int rate_eps, uint64_t seed, const std::vector<Burst>& bursts, bool deterministic_timing=false);
-  // Calculate next scheduled ts (ns) and event; returns false if past end time in deterministic mode
-  MdEvent next(double now_s);
-  // per-symbol initial mid
+  static constexpr size_t kBatch = 256;     // events drawn per refill
+  static constexpr size_t kFactorTick = 16; // events sharing one market-factor draw
+  static constexpr int kMaxSymbols = 65536; // MdEvent::symbol is 16-bit
+
+  // ticks: per-symbol tick sizes for quoting; nullptr = TickTable::kDefaultTick
+  MdFeed(int symbols, int rate_eps, uint64_t seed, const std::vector<Burst>& bursts, bool deterministic_timing=false,
+         const FeedConfig& cfg = FeedConfig{}, const TickTable* ticks = nullptr);
+
+  // Next event stamped at now_s. Symbols and moves are drawn kBatch events at a
+  // time; the burst correlation in effect at now_s applies from this event on.
+  MdEvent next(double now_s) {
+    if (now_s < corr_lo_ || now_s >= corr_hi_) update_corr(now_s);
+    if (pos_ == kBatch) refill();
+    return step(pos_++, stamp(now_s));
+  }
+  // Generate the next n events of the stream into out, all stamped at now_s.
+  // Same stream as n calls to next(now_s).
+  void next_batch(double now_s, MdEvent* out, size_t n);
+  // per-symbol mid of the underlying walk, in ticks (initially the starting prices)
   const std::vector<double>& initial_mids() const { return mids_; }
+
 private:
+  static constexpr double kMaxTicks = 2147483646.0; // keeps ask() within Ticks
+
+  static uint64_t stamp(double now_s) { return (uint64_t)(now_s * 1e9 + 0.5); }
+  void refill();                 // symbols and moves for the next kBatch events
+  void mix(size_t from);         // moves of buffered events [from, kBatch) at the current weights
+  void update_corr(double now_s); // correlation at now_s and the interval it holds for
+
+  // Step the mid of buffered event i's symbol
+  MdEvent step(size_t i, uint64_t ts) {
+    const int s = sym_[i];
+    double mid = std::min(std::max(mids_[s] * (1.0 + vol_[s] * move_[i]), 1.0), kMaxTicks);
+    mids_[s] = mid;
+    return MdEvent{ts, (Ticks)mid, (uint16_t)s, 1}; // one tick wide, bid at or below the mid
+  }
+
   int S_;
   int rate_;
   uint64_t seed_;
   std::vector<Burst> bursts_;
-  std::mt19937_64 rng_;
-  std::vector<double> mids_;
-  int sym_idx_ = -1; // for round-robin cycling per feed instance
+  Philox4x32 rng_;
+  uint64_t base_ = 0; // stream index of the next refill's first event (a multiple of kBatch)
+  std::vector<double> mids_; // in ticks
+  std::vector<double> vol_;
+  double corr_ = 0.0;
+  bool factor_on_ = false; // some correlation is configured: draw the market factor
+  // Correlation in effect on [corr_lo_, corr_hi_) and its weights
+  double corr_lo_ = 0.0, corr_hi_ = -1.0;
+  double a_ = 1.0, b_ = 0.0;
+  bool zipf_ = false;
+  std::vector<uint32_t> alias_thr_; // Vose alias table: keep column if 16-bit coin < thr
+  std::vector<int> alias_;
+  int sym_idx_ = -1; // round-robin cursor, advanced at refill
+  // Buffered draws for the next kBatch events: symbol, idiosyncratic move, one
+  // market factor per kFactorTick events, and the two mixed at the current
+  // correlation (a unit move, scaled by the symbol's vol in step())
+  uint16_t sym_[kBatch] = {};
+  double idio_[kBatch] = {};
+  double factor_[kBatch / kFactorTick] = {};
+  double move_[kBatch] = {};
+  size_t pos_ = kBatch;
 };
 
 } // namespace nhft
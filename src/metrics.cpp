@@ -13,7 +13,9 @@
 namespace nhft {
 
 LatencyRecorder::LatencyRecorder(double max_ms, int bins, size_t sample_cap)
-  : max_ms_(max_ms), bins_(bins), hist_(bins, 0), sample_cap_(sample_cap) {}
+  : max_ms_(max_ms), bins_(bins), hist_(bins, 0), sample_cap_(sample_cap) {
+  samples_.reserve(sample_cap_); // keep add_sample allocation-free
+}
 
 void LatencyRecorder::add_sample(double ms) {
   if (ms < 0) ms = 0;
@@ -60,7 +62,49 @@ std::string Metrics::to_json() const {
       << ", \"max\": " << p.max << ", \"jitter_ratio\": " << p.jitter_ratio << " }, ";
   oss << "\"throughput\": { \"eps\": " << eps << " }, ";
   oss << "\"reliability\": { \"drops\": " << reliability.drops << ", \"queue_depth_max\": " << reliability.queue_depth_max
-      << ", \"idempotency_violations\": " << reliability.idempotency_violations << ", \"exposure_blocks\": " << reliability.exposure_blocks << " }, ";
+      << ", \"idempotency_violations\": " << reliability.idempotency_violations << ", \"exposure_blocks\": " << reliability.exposure_blocks
+      << ", \"order_set_grows\": " << reliability.order_set_grows << " }, ";
+  oss << "\"startup\": { \"warm\": " << (startup.warm?"true":"false") << ", \"resumed_events\": " << startup.resumed_events
+      << ", \"restore_ms\": " << startup.restore_ms << ", \"ttfd_ms\": " << startup.ttfd_ms
+      << ", \"checkpoints\": " << startup.checkpoints << ", \"log_dropped\": " << startup.log_dropped << " }, ";
+  oss << "\"consumers\": { \"decisions\": [";
+  for (size_t i=0;i<consumers.decisions.size();++i) oss << (i?", ":"") << consumers.decisions[i];
+  oss << "], \"journal_events\": " << consumers.journal_events << " }, ";
+  auto phase_json = [&](const char* name, const AllocPhaseCount& c){
+    oss << "\"" << name << "\": { \"allocs\": " << c.allocs << ", \"bytes\": " << c.bytes << " }";
+  };
+  double per_event = allocs.hot_events ? (double)allocs.engine_hot.allocs / (double)allocs.hot_events : 0.0;
+  oss << "\"allocs\": { \"tracking\": " << (allocs.tracking?"true":"false")
+      << ", \"per_event\": " << std::setprecision(6) << per_event << std::setprecision(3)
+      << ", \"hot_events\": " << allocs.hot_events << ", \"engine\": { ";
+  phase_json("warmup", allocs.engine_warmup); oss << ", "; phase_json("hot", allocs.engine_hot);
+  oss << " }, \"feed\": { ";
+  phase_json("warmup", allocs.feed_warmup); oss << ", "; phase_json("hot", allocs.feed_hot);
+  oss << " }, \"forbid_violations\": " << allocs.forbid_violations << " }, ";
+  auto per_ev = [&](double v){ oss << std::setprecision(6) << (perf.events ? v / (double)perf.events : 0.0) << std::setprecision(3); };
+  oss << "\"perf\": { \"available\": " << (perf.available?"true":"false") << ", \"rdpmc\": " << (perf.rdpmc?"true":"false")
+      << ", \"events\": " << perf.events << ", \"per_event\": { ";
+  for (int i=0;i<kPerfEvents;++i) {
+    oss << (i?", ":"") << "\"" << perf_event_name((PerfEvent)i) << "\": ";
+    if (perf.totals.valid[i]) per_ev((double)perf.totals.value[i]); else oss << "null";
+  }
+  oss << " }, \"ipc\": ";
+  const int cyc = (int)PerfEvent::cycles, ins = (int)PerfEvent::instructions;
+  if (perf.totals.valid[cyc] && perf.totals.valid[ins] && perf.totals.value[cyc] > 0) {
+    oss << std::setprecision(6) << (double)perf.totals.value[ins] / (double)perf.totals.value[cyc] << std::setprecision(3);
+  } else {
+    oss << "null";
+  }
+  oss << ", \"stage_cycles_per_event\": ";
+  if (perf.rdpmc) {
+    oss << "{ \"strategy\": "; per_ev((double)perf.stage_cycles[0]);
+    oss << ", \"risk\": "; per_ev((double)perf.stage_cycles[1]);
+    oss << ", \"route\": "; per_ev((double)perf.stage_cycles[2]);
+    oss << " }";
+  } else {
+    oss << "null";
+  }
+  oss << " }, ";
   oss << "\"resources\": { \"rss_mb\": " << rss_mb << " } }";
   return oss.str();
 }
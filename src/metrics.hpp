@@ -3,6 +3,7 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include "perf_counters.hpp"
 
 namespace nhft {
 
@@ -30,6 +31,41 @@ struct ReliabilityCounters {
   uint64_t queue_depth_max = 0;
   uint64_t idempotency_violations = 0;
   uint64_t exposure_blocks = 0;
+  uint64_t order_set_grows = 0; // idempotency set reallocations (more orders than --max-orders)
+};
+
+struct ConsumerCounters {
+  std::vector<uint64_t> decisions; // per strategy consumer, primary first
+  uint64_t journal_events = 0;
+};
+
+struct StartupCounters {
+  bool warm = false;            // resumed from a state file checkpoint
+  uint64_t resumed_events = 0;  // events already processed before the restart
+  double restore_ms = 0.0;      // remap + validate + restore
+  double ttfd_ms = 0.0;         // engine start to first strategy decision
+  uint64_t checkpoints = 0;     // state file checkpoints written this run
+  uint64_t log_dropped = 0;     // fills the state file's order log could not hold (next start is cold)
+};
+
+struct AllocPhaseCount {
+  uint64_t allocs = 0;
+  uint64_t bytes = 0;
+};
+
+struct AllocCounters {
+  bool tracking = false;       // built with NANOHFT_ALLOC_TRACKING
+  uint64_t hot_events = 0;     // engine events processed after warmup
+  AllocPhaseCount engine_warmup, engine_hot, feed_warmup, feed_hot;
+  uint64_t forbid_violations = 0; // engine hot-path allocations under --forbid-hot-allocs
+};
+
+struct PerfReport {
+  bool available = false;       // at least one counter opened
+  bool rdpmc = false;           // per-stage cycles collected with rdpmc
+  uint64_t events = 0;          // engine events the totals cover
+  PerfSample totals;            // engine consumer loop
+  uint64_t stage_cycles[3]{};   // strategy, risk, route
 };
 
 struct Metrics {
@@ -46,6 +82,14 @@ struct Metrics {
   double eps = 0.0;
   // reliability
   ReliabilityCounters reliability;
+  // warm/cold start
+  StartupCounters startup;
+  // consumers sharing the feed
+  ConsumerCounters consumers;
+  // hardware/software counters
+  PerfReport perf;
+  // hot-path allocations
+  AllocCounters allocs;
   // resources
   double rss_mb = 0.0; // Linux only
 
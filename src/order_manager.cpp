@@ -0,0 +1,282 @@
+#include "order_manager.hpp"
+#include <cstring>
+
+namespace nhft {
+
+const char* order_state_name(OrderState s) {
+  switch (s) {
+    case OrderState::pending_new: return "pending_new";
+    case OrderState::live: return "live";
+    case OrderState::pending_cancel: return "pending_cancel";
+    case OrderState::in_doubt: return "in_doubt";
+    case OrderState::filled: return "filled";
+    case OrderState::cancelled: return "cancelled";
+    case OrderState::rejected: return "rejected";
+    case OrderState::timed_out: return "timed_out";
+  }
+  return "?";
+}
+
+static constexpr size_t kFrameAlign = 64;
+
+FramePool::FramePool(size_t blocks, size_t block_bytes)
+  : block_bytes_((block_bytes + kFrameAlign - 1) / kFrameAlign * kFrameAlign) {
+  size_t bytes = (blocks ? blocks : 1) * block_bytes_;
+  base_ = static_cast<unsigned char*>(::operator new(bytes, std::align_val_t{kFrameAlign}));
+  std::memset(base_, 0, bytes); // fault the pages in now, not on the first order in each block
+}
+
+FramePool::~FramePool() { ::operator delete(base_, std::align_val_t{kFrameAlign}); }
+
+OrderManager::OrderManager(const OrderManagerConfig& cfg, SpscRing<OrderRequest>& to_gateway,
+                           SpscRing<OrderReport>* reports)
+  : cfg_(cfg), out_(to_gateway), reports_(reports),
+    frames_(cfg.max_orders ? cfg.max_orders : 1, cfg.frame_bytes) {
+  if (cfg_.max_orders == 0) cfg_.max_orders = 1;
+  orders_.resize(cfg_.max_orders);
+  size_t ring = 1;
+  while (ring < cfg_.max_orders) ring <<= 1;
+  ready_.resize(ring); // power of two: the run queue wraps with a mask
+  free_.reserve(cfg_.max_orders);
+  // Hand out low slots first
+  for (uint32_t i = cfg_.max_orders; i-- > 0;) free_.push_back(i);
+}
+
+OrderManager::~OrderManager() {
+  for (auto& o : orders_) {
+    if (o.in_use && o.h) o.h.destroy();
+  }
+}
+
+uint32_t OrderManager::slot_of(uint64_t order_id) const {
+  uint32_t s = (uint32_t)order_id;
+  if (s >= orders_.size()) return kNone;
+  const Order& o = orders_[s];
+  return (o.in_use && o.gen == (uint32_t)(order_id >> 32)) ? s : kNone;
+}
+
+uint64_t OrderManager::submit(int sym, int side, int64_t qty, int64_t px, uint64_t now_ns) {
+  now_ns_ = now_ns;
+  if (free_.empty()) { ++stats_.pool_full; return 0; }
+  uint32_t s = free_.back();
+  Order& o = orders_[s];
+  o.qty = qty; o.px = px; o.filled = 0;
+  o.symbol = sym; o.side = (int8_t)side;
+  o.state = OrderState::pending_new;
+  Task t = lifecycle(s);
+  if (!t.h) { ++stats_.frame_too_large; return 0; }
+  free_.pop_back();
+  o.h = t.h;
+  o.in_use = true;
+  ++live_;
+  ++stats_.submitted;
+  uint64_t id = id_of(s);
+  schedule(s);
+  run_ready();
+  return id;
+}
+
+bool OrderManager::cancel(uint64_t order_id, uint64_t now_ns) {
+  now_ns_ = now_ns;
+  uint32_t s = slot_of(order_id);
+  if (s == kNone) return false;
+  deliver(s, GatewayEvent{order_id, now_ns, 0, 0, GatewayEventType::cancel_request});
+  run_ready();
+  return true;
+}
+
+size_t OrderManager::poll(SpscRing<GatewayEvent>& from_gateway, uint64_t now_ns, size_t max_events) {
+  now_ns_ = now_ns;
+  size_t n = 0;
+  GatewayEvent ev;
+  while (n < max_events && from_gateway.pop(ev)) {
+    ++n;
+    uint32_t s = slot_of(ev.order_id);
+    if (s == kNone) { ++stats_.unknown_events; continue; }
+    deliver(s, ev);
+  }
+  run_ready();
+  // Expire deadlines; each list is in deadline order, so stop at the first one in the future
+  for (Timer t : {kGatewayTimer, kTifTimer}) {
+    while (timers_[t].head != kNone && orders_[timers_[t].head].deadline <= now_ns) {
+      uint32_t s = timers_[t].head;
+      disarm(s);
+      deliver(s, GatewayEvent{id_of(s), now_ns, 0, 0, GatewayEventType::timeout});
+    }
+  }
+  run_ready();
+  return n;
+}
+
+bool OrderManager::find(uint64_t order_id, OrderState& state, int64_t& filled) const {
+  uint32_t s = slot_of(order_id);
+  if (s == kNone) return false;
+  state = orders_[s].state;
+  filled = orders_[s].filled;
+  return true;
+}
+
+bool OrderManager::send(uint32_t slot, RequestType type) {
+  const Order& o = orders_[slot];
+  if (out_.push(OrderRequest{id_of(slot), now_ns_, o.qty, o.px, o.symbol, o.side, type})) return true;
+  ++stats_.requests_dropped;
+  return false;
+}
+
+void OrderManager::finish(uint32_t slot, OrderState s) {
+  Order& o = orders_[slot];
+  disarm(slot);
+  o.state = s;
+  switch (s) {
+    case OrderState::filled: ++stats_.filled; break;
+    case OrderState::cancelled: ++stats_.cancelled; break;
+    case OrderState::rejected: ++stats_.rejected; break;
+    default: ++stats_.timed_out; break;
+  }
+  if (reports_ && !reports_->push(OrderReport{id_of(slot), now_ns_, o.qty, o.filled, o.symbol, o.side, s})) {
+    ++stats_.reports_dropped;
+  }
+}
+
+void OrderManager::doubt(uint32_t slot) {
+  Order& o = orders_[slot];
+  if (o.state != OrderState::in_doubt) { o.state = OrderState::in_doubt; ++stats_.in_doubt; }
+  send(slot, RequestType::cancel); // one that cannot be sent is retried when the timer fires
+  arm(slot, kGatewayTimer);
+}
+
+void OrderManager::arm(uint32_t slot, Timer t) {
+  disarm(slot);
+  uint64_t dur = t == kGatewayTimer ? cfg_.ack_timeout_ns : cfg_.tif_ns;
+  if (dur == 0) return;
+  Order& o = orders_[slot];
+  o.timer = t;
+  o.deadline = now_ns_ + dur;
+  TimerList& l = timers_[t];
+  o.prev = l.tail; o.next = kNone;
+  if (l.tail != kNone) orders_[l.tail].next = slot; else l.head = slot;
+  l.tail = slot;
+}
+
+void OrderManager::disarm(uint32_t slot) {
+  Order& o = orders_[slot];
+  if (o.timer == kNoTimer) return;
+  TimerList& l = timers_[o.timer];
+  if (o.prev != kNone) orders_[o.prev].next = o.next; else l.head = o.next;
+  if (o.next != kNone) orders_[o.next].prev = o.prev; else l.tail = o.prev;
+  o.prev = o.next = kNone;
+  o.timer = kNoTimer;
+}
+
+void OrderManager::deliver(uint32_t slot, const GatewayEvent& ev) {
+  Order& o = orders_[slot];
+  // One pending event per order: run the queue before overwriting it
+  if (o.scheduled) run_ready();
+  if (!o.in_use || o.gen != (uint32_t)(ev.order_id >> 32)) { ++stats_.unknown_events; return; }
+  o.ev = ev;
+  schedule(slot);
+}
+
+void OrderManager::schedule(uint32_t slot) {
+  orders_[slot].scheduled = true;
+  ready_[(ready_head_ + ready_n_++) & (ready_.size() - 1)] = slot;
+}
+
+void OrderManager::run_ready() {
+  while (ready_n_ > 0) {
+    uint32_t s = ready_[ready_head_];
+    ready_head_ = (ready_head_ + 1) & (ready_.size() - 1);
+    --ready_n_;
+    Order& o = orders_[s];
+    o.scheduled = false;
+    ++stats_.resumes;
+    o.h.resume();
+    if (o.h.done()) {
+      o.h.destroy();
+      o.h = {};
+      o.in_use = false;
+      if (++o.gen == 0) o.gen = 1; // IDs are never 0
+      free_.push_back(s);
+      --live_;
+    }
+  }
+}
+
+OrderManager::Task OrderManager::lifecycle(uint32_t slot) {
+  Order& o = orders_[slot];
+  bool want_cancel = false;
+  bool acked = false; // the gateway has confirmed the order
+
+  if (!send(slot, RequestType::new_order)) {
+    finish(slot, OrderState::rejected);
+    co_return;
+  }
+  arm(slot, kGatewayTimer);
+
+  // Pending new: wait for the gateway to accept or refuse the order
+  while (o.state == OrderState::pending_new) {
+    GatewayEvent ev = co_await Next{o};
+    switch (ev.type) {
+      case GatewayEventType::ack:
+        o.state = OrderState::live;
+        acked = true;
+        disarm(slot);
+        break;
+      case GatewayEventType::fill: // fill before the ack implies the ack
+        o.state = OrderState::live;
+        acked = true;
+        disarm(slot);
+        o.filled += ev.qty;
+        if (o.filled >= o.qty) finish(slot, OrderState::filled);
+        break;
+      case GatewayEventType::reject: finish(slot, OrderState::rejected); break;
+      case GatewayEventType::cancelled: finish(slot, OrderState::cancelled); break;
+      case GatewayEventType::timeout: doubt(slot); break; // the new may still reach the gateway
+      case GatewayEventType::cancel_request: want_cancel = true; break;
+    }
+  }
+
+  // Live until filled or cancelled. In doubt, keep cancelling until the gateway
+  // gives a final answer: the slot is only reused once nothing can arrive for it.
+  while (!order_done(o.state)) {
+    if (o.state == OrderState::live) {
+      if (want_cancel) {
+        // A cancel that cannot be sent is retried when the gateway timer fires
+        if (send(slot, RequestType::cancel)) { o.state = OrderState::pending_cancel; want_cancel = false; }
+        arm(slot, kGatewayTimer);
+      } else if (o.timer == kNoTimer) {
+        arm(slot, kTifTimer);
+      }
+    }
+    GatewayEvent ev = co_await Next{o};
+    switch (ev.type) {
+      case GatewayEventType::fill:
+        acked = true;
+        o.filled += ev.qty;
+        if (o.filled >= o.qty) finish(slot, OrderState::filled);
+        break;
+      case GatewayEventType::reject:
+        if (o.state == OrderState::pending_cancel || (o.state == OrderState::in_doubt && acked)) {
+          o.state = OrderState::live; // cancel refused: the order is still working
+          disarm(slot);
+        } else if (o.state == OrderState::in_doubt) {
+          finish(slot, OrderState::timed_out); // never acked, and the gateway does not hold it
+        }
+        break;
+      case GatewayEventType::cancelled: finish(slot, OrderState::cancelled); break;
+      case GatewayEventType::timeout:
+        if (o.state == OrderState::pending_cancel || o.state == OrderState::in_doubt) doubt(slot);
+        else want_cancel = true; // time in force expired, or a cancel retry is due
+        break;
+      case GatewayEventType::cancel_request:
+        if (o.state == OrderState::live) want_cancel = true;
+        break;
+      case GatewayEventType::ack: // late ack while in doubt: live, with our cancel in flight
+        if (o.state == OrderState::in_doubt && !acked) o.state = OrderState::pending_cancel;
+        acked = true;
+        break;
+    }
+  }
+}
+
+} // namespace nhft
@@ -0,0 +1,206 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <vector>
+#include "ringbuf.hpp"
+
+namespace nhft {
+
+// Order entry messages to the gateway
+enum class RequestType : uint8_t { new_order = 0, cancel = 1 };
+struct OrderRequest {
+  uint64_t order_id;
+  uint64_t ts_ns;
+  int64_t qty;
+  int64_t px; // ticks
+  int32_t symbol;
+  int8_t side; // +1 buy, -1 sell
+  RequestType type;
+};
+
+// Gateway responses. A fill carries the executed quantity and price; a reject
+// of a cancel means the cancel failed and the order stays live. timeout and
+// cancel_request are raised by the manager itself, never by the gateway.
+enum class GatewayEventType : uint8_t { ack = 0, fill = 1, reject = 2, cancelled = 3, timeout = 4, cancel_request = 5 };
+struct GatewayEvent {
+  uint64_t order_id;
+  uint64_t ts_ns;
+  int64_t qty;
+  int64_t px;
+  GatewayEventType type;
+};
+
+// in_doubt: the gateway stopped answering (a new or cancel timed out), so the
+// order may still be working there. The manager keeps it and sends cancels
+// until the gateway settles it. timed_out is final: a new was never
+// acknowledged and the gateway refused the cancel sent for it.
+enum class OrderState : uint8_t { pending_new, live, pending_cancel, in_doubt, filled, cancelled, rejected, timed_out };
+inline bool order_done(OrderState s) { return s >= OrderState::filled; }
+const char* order_state_name(OrderState s);
+
+// Final outcome of an order, emitted once when its lifecycle ends
+struct OrderReport {
+  uint64_t order_id;
+  uint64_t ts_ns;
+  int64_t qty;
+  int64_t filled;
+  int32_t symbol;
+  int8_t side;
+  OrderState state;
+};
+
+struct OrderManagerConfig {
+  uint32_t max_orders = 1u << 16;   // live orders (and coroutine frames) preallocated
+  uint64_t ack_timeout_ns = 50000000; // new or cancel without a gateway answer: in doubt, (re)send a cancel
+  uint64_t tif_ns = 0;              // live order lifetime before it is cancelled, 0 = good till cancel
+  size_t frame_bytes = 256;         // coroutine frame slot; larger frames fail every submit
+};
+
+// Fixed-size blocks for coroutine frames, one per order slot. Frames are placed
+// by slot index, so allocation and release are a pointer computation.
+class FramePool {
+public:
+  FramePool(size_t blocks, size_t block_bytes);
+  ~FramePool();
+  FramePool(const FramePool&) = delete;
+  FramePool& operator=(const FramePool&) = delete;
+
+  // nullptr if a frame of n bytes does not fit a block
+  void* get(uint32_t block, size_t n) const {
+    if (n > block_bytes_) return nullptr;
+    return base_ + (size_t)block * block_bytes_;
+  }
+  size_t block_bytes() const { return block_bytes_; }
+
+private:
+  unsigned char* base_;
+  size_t block_bytes_;
+};
+
+// Order lifecycle manager. Each outstanding order is a coroutine that walks the
+// order state machine, suspending until the next gateway event or timeout for
+// that order. Everything runs on the calling thread (the engine core):
+// submit()/cancel() and poll() queue coroutines on a ready list that the
+// executor drains before returning. All storage is allocated at construction.
+//
+// Order IDs are issued by the manager: slot index in the low 32 bits and a
+// per-slot generation in the high 32, so lookup is an array index and events
+// for a finished order never reach a reused slot.
+class OrderManager {
+public:
+  struct Stats {
+    uint64_t submitted = 0;
+    uint64_t filled = 0;
+    uint64_t cancelled = 0;
+    uint64_t rejected = 0;
+    uint64_t timed_out = 0;
+    uint64_t in_doubt = 0;         // timeouts that left an order in doubt
+    uint64_t pool_full = 0;        // submits refused: no free slot
+    uint64_t frame_too_large = 0;  // submits refused: lifecycle frame exceeds cfg.frame_bytes
+    uint64_t unknown_events = 0;   // gateway events for IDs that are not live
+    uint64_t requests_dropped = 0; // to-gateway ring full
+    uint64_t reports_dropped = 0;  // report ring full
+    uint64_t resumes = 0;
+  };
+
+  // to_gateway receives new/cancel requests; reports, if set, one OrderReport per finished order
+  OrderManager(const OrderManagerConfig& cfg, SpscRing<OrderRequest>& to_gateway,
+               SpscRing<OrderReport>* reports = nullptr);
+  ~OrderManager();
+  OrderManager(const OrderManager&) = delete;
+  OrderManager& operator=(const OrderManager&) = delete;
+
+  // Start an order; returns its ID, or 0 when the pool is exhausted or the frame does not fit
+  uint64_t submit(int sym, int side, int64_t qty, int64_t px, uint64_t now_ns);
+  // Request cancellation; false if the ID is not tracked. Before the ack the cancel
+  // is sent once the order is live; an order already being cancelled is unchanged.
+  bool cancel(uint64_t order_id, uint64_t now_ns);
+  // Drain gateway events and expire deadlines up to now_ns; returns events consumed
+  size_t poll(SpscRing<GatewayEvent>& from_gateway, uint64_t now_ns, size_t max_events = 256);
+
+  // State of a tracked order; false if the ID is not tracked
+  bool find(uint64_t order_id, OrderState& state, int64_t& filled) const;
+  size_t live() const { return live_; }
+  size_t capacity() const { return orders_.size(); }
+  const Stats& stats() const { return stats_; }
+
+private:
+  struct Task;
+  struct Next;
+
+  static constexpr uint32_t kNone = 0xFFFFFFFFu;
+  enum Timer : uint8_t { kNoTimer = 0, kGatewayTimer = 1, kTifTimer = 2 };
+
+  struct Order {
+    std::coroutine_handle<> h;
+    uint64_t deadline = 0;
+    int64_t qty = 0, px = 0, filled = 0;
+    GatewayEvent ev{}; // event being delivered to the coroutine
+    uint32_t gen = 1;
+    uint32_t prev = kNone, next = kNone; // intrusive deadline list
+    int32_t symbol = 0;
+    int8_t side = 0;
+    uint8_t timer = kNoTimer;
+    bool in_use = false;
+    bool scheduled = false;
+    OrderState state = OrderState::pending_new;
+  };
+
+  // Deadline FIFO: every timer of one kind has the same duration and now only
+  // moves forward, so appending keeps each list sorted by deadline.
+  struct TimerList { uint32_t head = kNone, tail = kNone; };
+
+  Task lifecycle(uint32_t slot);
+  uint64_t id_of(uint32_t slot) const { return ((uint64_t)orders_[slot].gen << 32) | slot; }
+  uint32_t slot_of(uint64_t order_id) const; // kNone if not live
+  bool send(uint32_t slot, RequestType type);
+  void finish(uint32_t slot, OrderState s);
+  void doubt(uint32_t slot);
+  void arm(uint32_t slot, Timer t);
+  void disarm(uint32_t slot);
+  void deliver(uint32_t slot, const GatewayEvent& ev);
+  void schedule(uint32_t slot);
+  void run_ready();
+
+  OrderManagerConfig cfg_;
+  SpscRing<OrderRequest>& out_;
+  SpscRing<OrderReport>* reports_;
+  FramePool frames_;
+  std::vector<Order> orders_;
+  std::vector<uint32_t> free_;  // free slot stack
+  std::vector<uint32_t> ready_; // executor run queue (ring), each slot at most once
+  size_t ready_head_ = 0, ready_n_ = 0;
+  TimerList timers_[3];
+  uint64_t now_ns_ = 0;
+  size_t live_ = 0;
+  Stats stats_;
+};
+
+// Coroutine type of one order's lifecycle. Frames come from the manager's
+// FramePool; a frame that does not fit makes the call return an empty Task.
+struct OrderManager::Task {
+  struct promise_type {
+    static void* operator new(size_t n, OrderManager& m, uint32_t slot) noexcept { return m.frames_.get(slot, n); }
+    static void operator delete(void*) noexcept {} // the pool owns the memory
+    static Task get_return_object_on_allocation_failure() noexcept { return Task{}; }
+    Task get_return_object() noexcept { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+    std::suspend_always initial_suspend() noexcept { return {}; } // first step runs on the executor
+    std::suspend_always final_suspend() noexcept { return {}; }   // the executor destroys it
+    void return_void() noexcept {}
+    void unhandled_exception() noexcept { std::terminate(); }
+  };
+  std::coroutine_handle<promise_type> h;
+};
+
+// Suspends the order until the executor resumes it with its next event
+struct OrderManager::Next {
+  Order& o;
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(std::coroutine_handle<>) const noexcept {}
+  GatewayEvent await_resume() const noexcept { return o.ev; }
+};
+
+} // namespace nhft
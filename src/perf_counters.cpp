@@ -0,0 +1,220 @@
+#include "perf_counters.hpp"
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace nhft {
+
+const char* perf_event_name(PerfEvent e) {
+  switch (e) {
+    case PerfEvent::cycles: return "cycles";
+    case PerfEvent::instructions: return "instructions";
+    case PerfEvent::l1d_misses: return "l1d_misses";
+    case PerfEvent::llc_misses: return "llc_misses";
+    case PerfEvent::branch_misses: return "branch_misses";
+    case PerfEvent::context_switches: return "context_switches";
+    case PerfEvent::page_faults: return "page_faults";
+  }
+  return "unknown";
+}
+
+PerfCounters::~PerfCounters() { close_all(); }
+
+bool PerfCounters::any_available() const {
+  for (int fd : fd_) if (fd >= 0) return true;
+  return false;
+}
+
+#ifdef __linux__
+
+namespace {
+
+constexpr int kHardware = 5; // PerfEvent::cycles .. branch_misses form the group
+
+int perf_open(uint32_t type, uint64_t config, int group_fd, uint64_t read_format, bool kernel = false) {
+  perf_event_attr attr{};
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = group_fd < 0 ? 1 : 0; // members follow the leader
+  attr.exclude_kernel = kernel ? 0 : 1; // user-only is permitted at perf_event_paranoid <= 2
+  attr.exclude_hv = 1;
+  attr.read_format = read_format;
+  return (int)syscall(SYS_perf_event_open, &attr, 0 /*this thread*/, -1 /*any cpu*/, group_fd, 0);
+}
+
+void event_config(PerfEvent e, uint32_t& type, uint64_t& config) {
+  switch (e) {
+    case PerfEvent::cycles: type = PERF_TYPE_HARDWARE; config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case PerfEvent::instructions: type = PERF_TYPE_HARDWARE; config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case PerfEvent::l1d_misses:
+      type = PERF_TYPE_HW_CACHE;
+      config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+      break;
+    case PerfEvent::llc_misses: type = PERF_TYPE_HARDWARE; config = PERF_COUNT_HW_CACHE_MISSES; break;
+    case PerfEvent::branch_misses: type = PERF_TYPE_HARDWARE; config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    case PerfEvent::context_switches: type = PERF_TYPE_SOFTWARE; config = PERF_COUNT_SW_CONTEXT_SWITCHES; break;
+    case PerfEvent::page_faults: type = PERF_TYPE_SOFTWARE; config = PERF_COUNT_SW_PAGE_FAULTS; break;
+  }
+}
+
+constexpr uint64_t kGroupFormat = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+constexpr uint64_t kSingleFormat = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+uint64_t scaled(uint64_t value, uint64_t enabled, uint64_t running) {
+  if (running == 0) return 0;
+  if (running >= enabled) return value;
+  return (uint64_t)((double)value * (double)enabled / (double)running);
+}
+
+} // namespace
+
+bool PerfCounters::open() {
+  close_all();
+  uint32_t type = 0; uint64_t config = 0;
+  event_config(PerfEvent::cycles, type, config);
+  leader_ = perf_open(type, config, -1, kGroupFormat);
+  if (leader_ >= 0) {
+    fd_[0] = leader_;
+    for (int i=1;i<kHardware;++i) {
+      event_config((PerfEvent)i, type, config);
+      fd_[i] = perf_open(type, config, leader_, kGroupFormat);
+    }
+    for (int i=kHardware-1;i>=0;--i) {
+      if (fd_[i] >= 0 && ioctl(fd_[i], PERF_EVENT_IOC_ID, &ids_[i]) != 0) { ::close(fd_[i]); fd_[i] = -1; }
+    }
+    if (fd_[0] < 0) { // group unreadable without the leader
+      for (int i=1;i<kHardware;++i) if (fd_[i] >= 0) { ::close(fd_[i]); fd_[i] = -1; }
+      leader_ = -1;
+    }
+  }
+  // Software events fire in kernel context: a user-only context switch count is
+  // always 0, so it is left unavailable rather than reported. User-only page
+  // faults are still real (the faulting address is in user space).
+  for (int i=kHardware;i<kPerfEvents;++i) {
+    event_config((PerfEvent)i, type, config);
+    fd_[i] = perf_open(type, config, -1, kSingleFormat, true);
+    if (fd_[i] < 0 && (PerfEvent)i == PerfEvent::page_faults) fd_[i] = perf_open(type, config, -1, kSingleFormat);
+  }
+
+#if defined(__x86_64__)
+  // User-space reads need the kernel to expose the counter index in the mmap page
+  const int rd[2] = {(int)PerfEvent::cycles, (int)PerfEvent::instructions};
+  rdpmc_ok_ = fd_[rd[0]] >= 0 && fd_[rd[1]] >= 0;
+  for (int k=0;k<2 && rdpmc_ok_;++k) {
+    void* p = mmap(nullptr, (size_t)sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd_[rd[k]], 0);
+    if (p == MAP_FAILED) { rdpmc_ok_ = false; break; }
+    mmap_[k] = p;
+    rdpmc_ok_ = static_cast<perf_event_mmap_page*>(p)->cap_user_rdpmc != 0;
+  }
+#endif
+  return any_available();
+}
+
+void PerfCounters::start() {
+  if (leader_ >= 0) {
+    ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+  for (int i=kHardware;i<kPerfEvents;++i) {
+    if (fd_[i] < 0) continue;
+    ioctl(fd_[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd_[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+void PerfCounters::stop() {
+  if (leader_ >= 0) ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  for (int i=kHardware;i<kPerfEvents;++i) if (fd_[i] >= 0) ioctl(fd_[i], PERF_EVENT_IOC_DISABLE, 0);
+}
+
+PerfSample PerfCounters::read() const {
+  PerfSample s{};
+  if (leader_ >= 0) {
+    // { nr, time_enabled, time_running, { value, id }[nr] }
+    uint64_t buf[3 + 2 * kHardware] = {};
+    if (::read(leader_, buf, sizeof(buf)) > 0) {
+      uint64_t nr = buf[0];
+      for (uint64_t j=0;j<nr && j<(uint64_t)kHardware;++j) {
+        uint64_t id = buf[3 + 2 * j + 1];
+        for (int i=0;i<kHardware;++i) {
+          if (fd_[i] >= 0 && ids_[i] == id) {
+            s.value[i] = scaled(buf[3 + 2 * j], buf[1], buf[2]);
+            s.valid[i] = buf[2] != 0;
+          }
+        }
+      }
+    }
+  }
+  for (int i=kHardware;i<kPerfEvents;++i) {
+    if (fd_[i] < 0) continue;
+    uint64_t buf[3] = {};
+    if (::read(fd_[i], buf, sizeof(buf)) == (ssize_t)sizeof(buf)) {
+      s.value[i] = scaled(buf[0], buf[1], buf[2]);
+      s.valid[i] = true;
+    }
+  }
+  return s;
+}
+
+uint64_t PerfCounters::rdpmc_read(int which) const {
+#if defined(__x86_64__)
+  auto* pc = static_cast<volatile perf_event_mmap_page*>(mmap_[which]);
+  if (!pc) return 0;
+  uint32_t seq, idx;
+  uint64_t count;
+  // Seqlock protocol from linux/perf_event.h
+  do {
+    seq = pc->lock;
+    __asm__ __volatile__("" ::: "memory");
+    idx = pc->index;
+    count = pc->offset;
+    if (pc->cap_user_rdpmc && idx) {
+      uint32_t lo, hi;
+      __asm__ __volatile__("rdpmc" : "=a"(lo), "=d"(hi) : "c"(idx - 1));
+      uint64_t raw = ((uint64_t)hi << 32) | lo;
+      uint16_t width = pc->pmc_width;
+      raw <<= 64 - width;
+      raw >>= 64 - width;
+      count += raw;
+    }
+    __asm__ __volatile__("" ::: "memory");
+  } while (pc->lock != seq);
+  return count;
+#else
+  (void)which;
+  return 0;
+#endif
+}
+
+void PerfCounters::close_all() {
+  for (int k=0;k<2;++k) {
+    if (mmap_[k]) munmap(mmap_[k], (size_t)sysconf(_SC_PAGESIZE));
+    mmap_[k] = nullptr;
+  }
+  for (int& fd : fd_) {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+  }
+  leader_ = -1;
+  rdpmc_ok_ = false;
+}
+
+#else // !__linux__
+
+bool PerfCounters::open() { return false; }
+void PerfCounters::start() {}
+void PerfCounters::stop() {}
+PerfSample PerfCounters::read() const { return PerfSample{}; }
+uint64_t PerfCounters::rdpmc_read(int) const { return 0; }
+void PerfCounters::close_all() {}
+
+#endif
+
+} // namespace nhft
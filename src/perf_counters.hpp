@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+
+namespace nhft {
+
+// Counters collected per thread; hardware ones share one perf_event group
+enum class PerfEvent : int {
+  cycles = 0, instructions, l1d_misses, llc_misses, branch_misses, // hardware group
+  context_switches, page_faults,                                     // software
+};
+constexpr int kPerfEvents = 7;
+const char* perf_event_name(PerfEvent e);
+
+struct PerfSample {
+  uint64_t value[kPerfEvents]{};
+  bool valid[kPerfEvents]{};
+};
+
+// perf_event_open counters for the calling thread (Linux only). Each counter is
+// opened independently, so a host that forbids hardware counters (paranoid level,
+// VMs without a PMU) still reports software ones; nothing here is fatal.
+// Where the kernel allows it, cycles and instructions can also be read from user
+// space with rdpmc for cheap per-stage attribution.
+class PerfCounters {
+public:
+  PerfCounters() = default;
+  ~PerfCounters();
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  // Open counters for the calling thread; returns true if any is available
+  bool open();
+  bool available(PerfEvent e) const { return fd_[(int)e] >= 0; }
+  bool any_available() const;
+
+  void start();
+  void stop();
+  // Totals since start(), scaled for multiplexing
+  PerfSample read() const;
+
+  // True if cycles/instructions can be read with rdpmc (x86-64 only)
+  bool has_rdpmc() const { return rdpmc_ok_; }
+  // Current raw cycles/instructions via rdpmc; only meaningful if has_rdpmc()
+  uint64_t rdpmc_cycles() const { return rdpmc_read(0); }
+  uint64_t rdpmc_instructions() const { return rdpmc_read(1); }
+
+private:
+  uint64_t rdpmc_read(int which) const;
+  void close_all();
+
+  int fd_[kPerfEvents] = {-1, -1, -1, -1, -1, -1, -1};
+  int leader_ = -1;          // hardware group leader fd
+  uint64_t ids_[kPerfEvents]{}; // kernel IDs of group members, to match group reads
+  void* mmap_[2] = {nullptr, nullptr}; // perf_event_mmap_page for cycles, instructions
+  bool rdpmc_ok_ = false;
+};
+
+} // namespace nhft
@@ -0,0 +1,169 @@
+#include "placement.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace nhft {
+
+#ifdef CPU_SETSIZE
+static constexpr int kMaxCpus = CPU_SETSIZE; // pin_current_thread() uses a cpu_set_t
+#else
+static constexpr int kMaxCpus = 1024;
+#endif
+
+bool PlacementSpec::known_role(const std::string& role) {
+  return role == "feed" || role == "engine" || role == "shadow" || role == "journal";
+}
+
+bool PlacementSpec::parse(const std::string& spec) {
+  std::vector<std::pair<std::string, int>> out;
+  std::stringstream ss(spec);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) continue;
+    auto eq = item.find('=');
+    if (eq == std::string::npos || eq == 0 || eq + 1 == item.size()) return false;
+    std::string role = item.substr(0, eq);
+    std::string cpu = item.substr(eq + 1);
+    if (!known_role(role)) return false;
+    // Digits only, and a CPU a cpu_set_t can hold (no sign, no overflow)
+    if (!std::all_of(cpu.begin(), cpu.end(), [](char c){ return c >= '0' && c <= '9'; })) return false;
+    int n = 0;
+    auto r = std::from_chars(cpu.data(), cpu.data() + cpu.size(), n);
+    if (r.ec != std::errc() || n >= kMaxCpus) return false;
+    out.emplace_back(role, n);
+  }
+  entries = std::move(out);
+  return true;
+}
+
+void PlacementSpec::set(const std::string& role, int cpu) {
+  for (auto& e : entries) {
+    if (e.first == role) { e.second = cpu; return; }
+  }
+  entries.emplace_back(role, cpu);
+}
+
+int PlacementSpec::cpu_for(const std::string& role, int index) const {
+  for (auto& e : entries) {
+    if (e.first == role && index-- == 0) return e.second;
+  }
+  return -1;
+}
+
+std::vector<int> isolated_cpus() {
+  std::vector<int> cpus;
+#ifdef __linux__
+  // Kernel cpulist format: "2-3,6"
+  std::ifstream f("/sys/devices/system/cpu/isolated");
+  std::string list;
+  if (!std::getline(f, list)) return cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    int lo = 0, hi = 0;
+    if (std::sscanf(range.c_str(), "%d-%d", &lo, &hi) == 2) { for (int c=lo;c<=hi;++c) cpus.push_back(c); }
+    else if (std::sscanf(range.c_str(), "%d", &lo) == 1) cpus.push_back(lo);
+  }
+#endif
+  return cpus;
+}
+
+int numa_node_of_cpu(int cpu) {
+#ifdef __linux__
+  if (cpu < 0) return -1;
+  // /sys/devices/system/cpu/cpuN/nodeK links exist only on NUMA-enabled kernels
+  std::error_code ec;
+  std::filesystem::directory_iterator it("/sys/devices/system/cpu/cpu" + std::to_string(cpu), ec);
+  if (ec) return -1;
+  for (auto& e : it) {
+    std::string name = e.path().filename().string();
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0) return std::atoi(name.c_str() + 4);
+  }
+  return 0;
+#else
+  (void)cpu;
+  return -1;
+#endif
+}
+
+int current_cpu() {
+#ifdef __linux__
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+
+ThreadPlacement place_current_thread(const std::string& role, int cpu, int rt_priority) {
+  ThreadPlacement p;
+  p.role = role;
+  p.requested_cpu = cpu;
+  if (cpu >= 0 && pin_to_cpu(cpu)) std::this_thread::yield(); // let the scheduler migrate us
+#ifdef __linux__
+  if (rt_priority > 0) {
+    sched_param sp{};
+    sp.sched_priority = std::min(rt_priority, sched_get_priority_max(SCHED_FIFO));
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    if (rc != 0) std::fprintf(stderr, "[warn] SCHED_FIFO not permitted for %s: %s\n", role.c_str(), std::strerror(rc));
+  }
+  int policy = 0;
+  sched_param cur{};
+  if (pthread_getschedparam(pthread_self(), &policy, &cur) == 0) {
+    p.sched = policy == SCHED_FIFO ? "SCHED_FIFO" : policy == SCHED_RR ? "SCHED_RR" : "SCHED_OTHER";
+    p.priority = cur.sched_priority;
+  }
+#else
+  (void)rt_priority;
+#endif
+  p.cpu = current_cpu();
+  p.numa_node = numa_node_of_cpu(p.cpu);
+  auto iso = isolated_cpus();
+  p.isolated = p.cpu >= 0 && std::find(iso.begin(), iso.end(), p.cpu) != iso.end();
+  return p;
+}
+
+ScopedCpuBinding::ScopedCpuBinding(int cpu) {
+#ifdef __linux__
+  static_assert(sizeof(cpu_set_t) <= sizeof(saved_), "cpu_set_t storage too small");
+  if (cpu < 0) return;
+  cpu_set_t* saved = reinterpret_cast<cpu_set_t*>(saved_);
+  if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), saved) != 0) return;
+  active_ = pin_to_cpu(cpu);
+#else
+  (void)cpu;
+#endif
+}
+
+ScopedCpuBinding::~ScopedCpuBinding() {
+#ifdef __linux__
+  if (active_) pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), reinterpret_cast<cpu_set_t*>(saved_));
+#endif
+}
+
+std::string PlacementLog::fingerprint() const {
+  std::ostringstream oss;
+  oss << "online_cpus=" << std::thread::hardware_concurrency() << "\nisolated_cpus=";
+  auto iso = isolated_cpus();
+  for (size_t i=0;i<iso.size();++i) oss << (i?",":"") << iso[i];
+  oss << "\n";
+  std::lock_guard<std::mutex> lk(m_);
+  for (auto& p : items_) {
+    oss << "placement." << p.role << "=requested:" << p.requested_cpu << " cpu:" << p.cpu << " node:" << p.numa_node
+        << " isolated:" << (p.isolated ? 1 : 0) << " sched:" << p.sched << " prio:" << p.priority << "\n";
+  }
+  return oss.str();
+}
+
+} // namespace nhft
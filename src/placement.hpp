@@ -0,0 +1,71 @@
+#pragma once
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace nhft {
+
+// Per-thread CPU placement, parsed from e.g. "feed=2,engine=4,journal=6".
+// A role may repeat ("shadow=5,shadow=7") to place the k-th thread of that role.
+struct PlacementSpec {
+  static constexpr const char* kRoles = "feed, engine, shadow, journal";
+  std::vector<std::pair<std::string, int>> entries;
+
+  static bool known_role(const std::string& role);
+  // Returns false (and leaves the spec unchanged) on malformed input or an unknown role
+  bool parse(const std::string& spec);
+  // Place the first thread of role on cpu, replacing any earlier entry for it
+  void set(const std::string& role, int cpu);
+  // CPU for the index-th thread of role, or -1 if unplaced
+  int cpu_for(const std::string& role, int index = 0) const;
+  bool empty() const { return entries.empty(); }
+};
+
+// Where a thread actually ended up
+struct ThreadPlacement {
+  std::string role;
+  int requested_cpu = -1;
+  int cpu = -1;          // CPU the thread was running on after placement
+  int numa_node = -1;
+  bool isolated = false; // cpu is in the kernel's isolcpus set
+  std::string sched = "SCHED_OTHER";
+  int priority = 0;
+};
+
+// CPUs listed in /sys/devices/system/cpu/isolated (Linux only)
+std::vector<int> isolated_cpus();
+// NUMA node of cpu, or -1 if unknown
+int numa_node_of_cpu(int cpu);
+// CPU the calling thread is running on, or -1 if unknown
+int current_cpu();
+
+// Pin the calling thread to cpu (if >= 0) and, if rt_priority > 0, try SCHED_FIFO
+// at that priority. Best effort: failures are reported in the result, not fatal.
+ThreadPlacement place_current_thread(const std::string& role, int cpu, int rt_priority);
+
+// Temporarily binds the calling thread to cpu so that first-touch allocations made
+// in scope land on that CPU's NUMA node; restores the previous mask on destruction.
+class ScopedCpuBinding {
+public:
+  explicit ScopedCpuBinding(int cpu);
+  ~ScopedCpuBinding();
+  ScopedCpuBinding(const ScopedCpuBinding&) = delete;
+  ScopedCpuBinding& operator=(const ScopedCpuBinding&) = delete;
+private:
+  bool active_ = false;
+  unsigned char saved_[128]{}; // cpu_set_t storage
+};
+
+// Thread-safe collection of placements for run_fingerprint.txt
+class PlacementLog {
+public:
+  void add(ThreadPlacement p) { std::lock_guard<std::mutex> lk(m_); items_.push_back(std::move(p)); }
+  // One "placement.<role>=..." line per thread, plus host CPU/isolation info
+  std::string fingerprint() const;
+private:
+  mutable std::mutex m_;
+  std::vector<ThreadPlacement> items_;
+};
+
+} // namespace nhft
@@ -0,0 +1,49 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace nhft {
+
+// Prices travel through the pipeline as integer ticks of their symbol, money as
+// integer micro-units of the quote currency. Both are exact, so comparisons,
+// hashing and risk arithmetic never round; conversion to floating point happens
+// only when reporting.
+using Ticks = int32_t;
+using Money = int64_t;
+constexpr Money kMoneyPerUnit = 1000000;
+
+inline double money_to_double(Money m) { return (double)m / (double)kMoneyPerUnit; }
+inline Money money_from_double(double v) { return (Money)std::llround(v * (double)kMoneyPerUnit); }
+
+// Per-symbol tick sizes. Tick sizes are rounded to whole micro-units so one tick
+// of one unit is an exact amount of Money.
+class TickTable {
+public:
+  static constexpr double kDefaultTick = 0.01;
+
+  // tick_sizes: empty = kDefaultTick for all, one value for all, or one per symbol
+  explicit TickTable(int symbols, const std::vector<double>& tick_sizes = {}) {
+    double fill = tick_sizes.empty() ? kDefaultTick : tick_sizes.back();
+    value_.assign((size_t)std::max(1, symbols), tick_money(fill));
+    for (size_t i=0;i<tick_sizes.size() && i<value_.size();++i) value_[i] = tick_money(tick_sizes[i]);
+  }
+
+  int symbols() const { return (int)value_.size(); }
+  // Money per tick for one unit
+  Money tick_value(int sym) const { return value_[sym]; }
+  double tick_size(int sym) const { return money_to_double(value_[sym]); }
+
+  Money notional(int sym, int64_t qty, int64_t ticks) const { return qty * ticks * value_[sym]; }
+  double to_price(int sym, int64_t ticks) const { return (double)(ticks * value_[sym]) / (double)kMoneyPerUnit; }
+  // Nearest tick at or below px
+  int64_t floor_ticks(int sym, double px) const { return (int64_t)std::floor(px * (double)kMoneyPerUnit / (double)value_[sym]); }
+
+private:
+  static Money tick_money(double tick) { return std::max<Money>(1, money_from_double(tick)); }
+
+  std::vector<Money> value_;
+};
+
+} // namespace nhft
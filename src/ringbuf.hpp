@@ -17,7 +17,7 @@ public:
       capacity_ = 1024;
       mask_ = capacity_ - 1;
     }
-    buf_ = new T[capacity_];
+    buf_ = new T[capacity_](); // value-init touches the pages on the constructing thread's node
     head_.store(0, std::memory_order_relaxed);
     tail_.store(0, std::memory_order_relaxed);
   }
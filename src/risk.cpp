@@ -1,29 +1,41 @@
 #include "risk.hpp"
-#include <cmath>
+#include <cstdlib>
 
 namespace nhft {
 
-Risk::Risk(int symbols, double per_trade_notional_cap, double daily_loss_cap)
-  : per_trade_cap_(per_trade_notional_cap), daily_loss_cap_(daily_loss_cap), position_(symbols, 0.0) {}
+Risk::Risk(const TickTable& ticks, Money per_trade_notional_cap, Money daily_loss_cap)
+  : ticks_(ticks), per_trade_cap_(per_trade_notional_cap), daily_loss_cap_(daily_loss_cap), position_(ticks.symbols(), 0) {}
 
-RiskResult Risk::check(int sym, int side, double qty, double px) {
+RiskResult Risk::check(int sym, int side, int64_t qty, int64_t px) {
   RiskResult r{};
-  double notional = std::abs(qty * px);
+  Money notional = std::abs(ticks_.notional(sym, qty, px));
   if (notional > per_trade_cap_) {
-    r.allowed = false; r.reason = "per_trade_cap"; last_reason_ = r.reason; exposure_blocks_++; return r;
+    r.allowed = false; r.code = RiskCode::per_trade_cap; r.reason = "per_trade_cap"; last_reason_ = r.reason; exposure_blocks_++; return r;
   }
   if (pnl_ <= -daily_loss_cap_) {
-    r.allowed = false; r.reason = "daily_loss_cap"; last_reason_ = r.reason; exposure_blocks_++; return r;
+    r.allowed = false; r.code = RiskCode::daily_loss_cap; r.reason = "daily_loss_cap"; last_reason_ = r.reason; exposure_blocks_++; return r;
   }
-  (void)sym; (void)side; // further per-symbol risk could be added
+  (void)side; // further per-symbol risk could be added
   return r;
 }
 
-void Risk::on_fill(int sym, int side, double qty, double px) {
+void Risk::on_fill(int sym, int side, int64_t qty, int64_t px) {
   // side: +1 buy, -1 sell
   position_[sym] += side * qty;
   // mark-to-market PnL effect: assume IOC incurs a meaningful cost to demonstrate caps
-  pnl_ -= 0.01 * std::abs(qty) * px; // 1% notional cost per fill (teaching/demo value)
+  pnl_ -= std::abs(ticks_.notional(sym, qty, px)) / 100; // 1% notional cost per fill (teaching/demo value)
+}
+
+void Risk::save_state(int64_t* position, Money& pnl, uint64_t& exposure_blocks) const {
+  for (size_t i=0;i<position_.size();++i) position[i] = position_[i];
+  pnl = pnl_;
+  exposure_blocks = exposure_blocks_;
+}
+
+void Risk::load_state(const int64_t* position, Money pnl, uint64_t exposure_blocks) {
+  for (size_t i=0;i<position_.size();++i) position_[i] = position[i];
+  pnl_ = pnl;
+  exposure_blocks_ = exposure_blocks;
 }
 
 } // namespace nhft
@@ -2,29 +2,39 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include "price.hpp"
 
 namespace nhft {
 
+enum class RiskCode : uint8_t { ok = 0, per_trade_cap = 1, daily_loss_cap = 2 };
+
 struct RiskResult {
   bool allowed = true;
-  std::string reason;
+  RiskCode code = RiskCode::ok;
+  const char* reason = ""; // static string; no allocation on the check path
 };
 
 class Risk {
 public:
-  Risk(int symbols, double per_trade_notional_cap=10000.0, double daily_loss_cap=1000.0);
-  RiskResult check(int sym, int side, double qty, double px);
-  void on_fill(int sym, int side, double qty, double px);
-  double pnl() const { return pnl_; }
+  // Caps in Money; qty in units and prices in ticks of the symbol
+  Risk(const TickTable& ticks, Money per_trade_notional_cap=10000 * kMoneyPerUnit, Money daily_loss_cap=1000 * kMoneyPerUnit);
+  RiskResult check(int sym, int side, int64_t qty, int64_t px);
+  void on_fill(int sym, int side, int64_t qty, int64_t px);
+  Money pnl() const { return pnl_; }
   uint64_t exposure_blocks() const { return exposure_blocks_; }
-  std::string last_reason() const { return last_reason_; }
+  const char* last_reason() const { return last_reason_; }
+  int symbols() const { return (int)position_.size(); }
+  // Raw state (positions: symbols() entries) for checkpoint/restore
+  void save_state(int64_t* position, Money& pnl, uint64_t& exposure_blocks) const;
+  void load_state(const int64_t* position, Money pnl, uint64_t exposure_blocks);
 private:
-  double per_trade_cap_;
-  double daily_loss_cap_;
-  std::vector<double> position_;
-  double pnl_ = 0.0;
+  TickTable ticks_;
+  Money per_trade_cap_;
+  Money daily_loss_cap_;
+  std::vector<int64_t> position_;
+  Money pnl_ = 0;
   uint64_t exposure_blocks_ = 0;
-  std::string last_reason_;
+  const char* last_reason_ = "";
 };
 
 } // namespace nhft
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace nhft {
+
+// Philox4x32-10 counter-based generator (Salmon et al., SC'11). Each output block
+// is a pure function of (counter, key): blocks can be generated out of order or
+// in independent SIMD lanes and still reproduce exactly for a given seed.
+class Philox4x32 {
+public:
+  static constexpr int kLanes = 8; // counters processed side by side in fill()
+
+  explicit Philox4x32(uint64_t seed) : k0_((uint32_t)seed), k1_((uint32_t)(seed >> 32)) {}
+
+  // Four words for counter {c0, c1, c2, c3}
+  static void block(const uint32_t ctr[4], uint32_t k0, uint32_t k1, uint32_t out[4]) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    for (int r = 0; r < 10; ++r) {
+      round(c0, c1, c2, c3, k0, k1);
+      k0 += kW0; k1 += kW1;
+    }
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+  }
+
+  // Fill out[0..4*blocks) with the blocks for counters {first + i, stream, 0, 0}.
+  // Lanes are laid out structure-of-arrays inside the rounds so kLanes
+  // independent counters are in flight at once.
+  void fill(uint64_t first, uint32_t stream, uint32_t* out, size_t blocks) const {
+    const uint32_t key_lo = k0_, key_hi = k1_; // out may alias *this as far as the compiler knows
+    size_t i = 0;
+    for (; i + kLanes <= blocks; i += kLanes) {
+      uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+      for (int j = 0; j < kLanes; ++j) {
+        uint64_t n = first + i + (uint64_t)j;
+        c0[j] = (uint32_t)n; c1[j] = (uint32_t)(n >> 32); c2[j] = stream; c3[j] = 0;
+      }
+      uint32_t k0 = key_lo, k1 = key_hi;
+      for (int r = 0; r < 10; ++r) {
+        for (int j = 0; j < kLanes; ++j) round(c0[j], c1[j], c2[j], c3[j], k0, k1);
+        k0 += kW0; k1 += kW1;
+      }
+      for (int j = 0; j < kLanes; ++j) {
+        uint32_t* o = out + 4 * (i + (size_t)j);
+        o[0] = c0[j]; o[1] = c1[j]; o[2] = c2[j]; o[3] = c3[j];
+      }
+    }
+    for (int j = 0; j < kLanes && i < blocks; ++j, ++i) { // ragged tail, fewer than kLanes
+      uint64_t n = first + i;
+      const uint32_t ctr[4] = {(uint32_t)n, (uint32_t)(n >> 32), stream, 0};
+      block(ctr, key_lo, key_hi, out + 4 * i);
+    }
+  }
+
+  uint32_t key0() const { return k0_; }
+  uint32_t key1() const { return k1_; }
+
+private:
+  static constexpr uint32_t kM0 = 0xD2511F53u, kM1 = 0xCD9E8D57u;
+  static constexpr uint32_t kW0 = 0x9E3779B9u, kW1 = 0xBB67AE85u;
+
+  static void round(uint32_t& c0, uint32_t& c1, uint32_t& c2, uint32_t& c3, uint32_t k0, uint32_t k1) {
+    uint64_t p0 = (uint64_t)kM0 * c0;
+    uint64_t p1 = (uint64_t)kM1 * c2;
+    uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    c1 = (uint32_t)p1; c3 = (uint32_t)p0;
+    c0 = n0; c2 = n2;
+  }
+
+  uint32_t k0_, k1_;
+};
+
+// Uniform in [-1, 1) from one random word
+inline double rng_signed_unit(uint32_t w) { return (double)(int32_t)w * (1.0 / 2147483648.0); }
+
+// Uniform integer in [0, n) from one random word (multiply-shift, no division)
+inline uint32_t rng_below(uint32_t w, uint32_t n) { return (uint32_t)(((uint64_t)w * n) >> 32); }
+
+} // namespace nhft
@@ -1,8 +1,10 @@
 #pragma once
-#include <unordered_set>
 #include <string>
+#include <string_view>
 #include <fstream>
 #include <cstdint>
+#include "id_set.hpp"
+#include "price.hpp"
 
 namespace nhft {
 
@@ -10,19 +12,30 @@ struct Trade {
   uint64_t ts_ns;
   int symbol;
   int side; // +1 buy, -1 sell
-  double qty;
-  double px;
+  int64_t qty;
+  int64_t px; // ticks
   std::string reason;
 };
 
 class Router {
 public:
-  Router(uint64_t seed, const std::string& trades_csv_path);
-  // Returns true if filled; idempotent order IDs; track duplicates
-  bool ioc_fill(uint64_t order_id, uint64_t ts_ns, int sym, int side, double qty, double mid, double half_spread, const std::string& reason_ex);
+  static constexpr size_t kDefaultMaxOrders = 1u << 18; // --max-orders: also the state file's order log capacity
+
+  // max_orders: order IDs the idempotency set holds without reallocating
+  Router(uint64_t seed, const std::string& trades_csv_path, const TickTable& ticks, size_t max_orders = kDefaultMaxOrders);
+  // Fill price for an IOC crossing the spread: the ask for a buy, the bid for a sell
+  static int64_t ioc_price(int side, int64_t bid, int64_t ask) { return side > 0 ? ask : bid; }
+  // Returns true if filled; idempotent order IDs; track duplicates.
+  // px is in ticks; trades.csv reports it as a price.
+  bool ioc_fill(uint64_t order_id, uint64_t ts_ns, int sym, int side, int64_t qty, int64_t px, std::string_view reason_ex);
   uint64_t idempotency_violations() const { return idem_violations_; }
+  // Times the idempotency set outgrew max_orders and reallocated
+  uint64_t id_set_grows() const { return seen_.grows(); }
+  // Re-register an order ID routed before a restart
+  void restore_seen(uint64_t order_id) { seen_.insert(order_id); }
 private:
-  std::unordered_set<uint64_t> seen_;
+  IdSet seen_; // preallocated: no per-order node allocation
+  TickTable ticks_;
   std::ofstream out_;
   uint64_t seed_;
   uint64_t idem_violations_ = 0;
@@ -0,0 +1,275 @@
+#include "snapshot.hpp"
+#include "strategy.hpp"
+#include "risk.hpp"
+#include "router.hpp"
+#include "util.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define NHFT_HAVE_MMAP 1
+#endif
+
+namespace nhft {
+
+namespace {
+
+struct FileHeader {
+  char magic[8];        // "NHFTST1"
+  uint32_t version;
+  uint32_t symbols;
+  uint64_t log_capacity;
+  uint64_t bytes;
+  uint64_t tick_hash;   // over the per-symbol tick values
+  uint64_t log_dropped; // fills the order log could not hold, over the file's life
+  uint64_t reserved[2];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader must stay one cache line");
+
+// Followed by prev_mid[S] (int64), ewma[S], ewvar[S] (double), position[S] (int64)
+struct SlotHeader {
+  uint64_t checksum;    // FNV-1a over the rest of the slot
+  uint64_t generation;  // 0 = never written
+  uint64_t events;
+  uint64_t order_seq;
+  uint64_t log_len;
+  uint64_t log_hash;
+  int64_t pnl;          // Money
+  uint64_t exposure_blocks;
+};
+static_assert(sizeof(SlotHeader) == 64, "SlotHeader must stay one cache line");
+
+constexpr size_t align64(size_t n) { return (n + 63) & ~size_t(63); }
+
+uint64_t tick_hash(const TickTable& ticks) {
+  uint64_t h = 1469598103934665603ull;
+  for (int i=0;i<ticks.symbols();++i) {
+    Money v = ticks.tick_value(i);
+    h = (h ^ fnv1a64(&v, sizeof(v))) * 1099511628211ull;
+  }
+  return h;
+}
+
+uint64_t mix_entry(uint64_t h, const OrderLogEntry& e) {
+  return (h ^ fnv1a64(&e, sizeof(e))) * 1099511628211ull;
+}
+
+// k-th per-symbol array of 8-byte entries after the slot header
+template <typename T>
+T* slot_array(unsigned char* slot, int symbols, int k) {
+  static_assert(sizeof(T) == 8, "slot arrays hold 8-byte entries");
+  return reinterpret_cast<T*>(slot + sizeof(SlotHeader)) + (size_t)k * symbols;
+}
+
+} // namespace
+
+StateFile::~StateFile() { close(); }
+
+unsigned char* StateFile::slot_ptr(int i) const {
+  return base_ + sizeof(FileHeader) + (size_t)i * slot_bytes_;
+}
+
+uint64_t StateFile::slot_checksum(const unsigned char* slot) const {
+  return fnv1a64(slot + sizeof(uint64_t), slot_bytes_ - sizeof(uint64_t));
+}
+
+bool StateFile::open(const std::string& path, const TickTable& ticks, size_t log_capacity) {
+#ifdef NHFT_HAVE_MMAP
+  close();
+  const int symbols = ticks.symbols();
+  const uint64_t th = tick_hash(ticks);
+  symbols_ = symbols;
+  log_capacity_ = log_capacity;
+  slot_bytes_ = align64(sizeof(SlotHeader) + 4 * sizeof(uint64_t) * (size_t)symbols);
+  size_t log_off = sizeof(FileHeader) + 2 * slot_bytes_;
+  bytes_ = log_off + log_capacity * sizeof(OrderLogEntry);
+
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd_ < 0) { std::cerr << "[warn] state file open failed: " << path << "\n"; return false; }
+
+  // Validate the existing layout before mapping; anything else starts cold
+  struct stat st{};
+  FileHeader h{};
+  bool valid = fstat(fd_, &st) == 0 && (size_t)st.st_size == bytes_
+            && pread(fd_, &h, sizeof(h), 0) == (ssize_t)sizeof(h)
+            && std::memcmp(h.magic, "NHFTST1", 8) == 0 && h.version == kVersion
+            && h.symbols == (uint32_t)symbols && h.log_capacity == log_capacity && h.bytes == bytes_
+            && h.tick_hash == th;
+  if (!valid && (ftruncate(fd_, 0) != 0 || ftruncate(fd_, (off_t)bytes_) != 0)) {
+    std::cerr << "[warn] state file resize failed: " << path << "\n";
+    ::close(fd_); fd_ = -1;
+    return false;
+  }
+
+  void* p = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  if (p == MAP_FAILED) {
+    std::cerr << "[warn] state file mmap failed: " << path << "\n";
+    ::close(fd_); fd_ = -1;
+    return false;
+  }
+  base_ = static_cast<unsigned char*>(p);
+  log_ = reinterpret_cast<OrderLogEntry*>(base_ + log_off);
+  if (!valid) {
+    h = FileHeader{};
+    std::memcpy(h.magic, "NHFTST1", 8);
+    h.version = kVersion;
+    h.symbols = (uint32_t)symbols;
+    h.log_capacity = log_capacity;
+    h.bytes = bytes_;
+    h.tick_hash = th;
+    std::memcpy(base_, &h, sizeof(h));
+  }
+  log_len_ = 0;
+  log_hash_ = 0;
+  log_dropped_ = 0;
+  checkpoints_ = 0;
+  generation_ = 0;
+  valid_slot_ = -1;
+  for (int i=0;i<2;++i) {
+    generation_ = std::max(generation_, reinterpret_cast<const SlotHeader*>(slot_ptr(i))->generation);
+  }
+  return true;
+#else
+  (void)path; (void)ticks; (void)log_capacity;
+  std::cerr << "[warn] state file not supported on this platform\n";
+  return false;
+#endif
+}
+
+bool StateFile::restore(Strategy& strat, Risk& risk, Router& router, EngineCursor& cur) {
+  if (!is_open() || strat.symbols() != symbols_ || risk.symbols() != symbols_) return false;
+
+  FileHeader* fh = reinterpret_cast<FileHeader*>(base_);
+  if (fh->log_dropped != 0) {
+    // Fills routed after the last checkpoint may be missing from the log, and
+    // with them positions and idempotency IDs: nothing here can be trusted
+    std::cerr << "[warn] state file order log overflowed (" << fh->log_dropped
+              << " fills not logged); starting cold\n";
+    std::memset(base_ + sizeof(FileHeader), 0, bytes_ - sizeof(FileHeader));
+    fh->log_dropped = 0;
+    generation_ = 0;
+    valid_slot_ = -1;
+    return false;
+  }
+
+  // Newest slot whose checksum and committed log prefix both verify
+  int best = -1;
+  uint64_t best_gen = 0;
+  bool any_written = false;
+  for (int i=0;i<2;++i) {
+    const unsigned char* s = slot_ptr(i);
+    const SlotHeader* sh = reinterpret_cast<const SlotHeader*>(s);
+    if (sh->generation == 0) continue;
+    any_written = true;
+    if (sh->checksum != slot_checksum(s) || sh->log_len > log_capacity_ || sh->generation <= best_gen) continue;
+    uint64_t h = 0;
+    for (size_t k=0;k<sh->log_len;++k) h = mix_entry(h, log_[k]);
+    if (h != sh->log_hash) continue;
+    best = i;
+    best_gen = sh->generation;
+  }
+  if (any_written && best < 0) {
+    // Every checkpoint is corrupt: the order log cannot be trusted either
+    std::cerr << "[warn] state file failed integrity checks; starting cold\n";
+    std::memset(base_ + sizeof(FileHeader), 0, bytes_ - sizeof(FileHeader));
+    generation_ = 0;
+    valid_slot_ = -1;
+    return false;
+  }
+  valid_slot_ = best;
+
+  size_t n = 0;
+  if (best >= 0) {
+    unsigned char* s = slot_ptr(best);
+    const SlotHeader* sh = reinterpret_cast<const SlotHeader*>(s);
+    strat.load_state(slot_array<int64_t>(s, symbols_, 0), slot_array<double>(s, symbols_, 1), slot_array<double>(s, symbols_, 2));
+    risk.load_state(slot_array<int64_t>(s, symbols_, 3), sh->pnl, sh->exposure_blocks);
+    cur.events = sh->events;
+    cur.order_seq = sh->order_seq;
+    n = sh->log_len;
+    log_hash_ = sh->log_hash;
+    for (size_t k=0;k<n;++k) router.restore_seen(log_[k].order_id);
+  }
+  // Fills routed after the checkpoint: re-apply to risk so positions stay exact
+  size_t replayed = 0;
+  while (n < log_capacity_ && log_[n].seq != 0 && log_[n].symbol >= 0 && log_[n].symbol < symbols_) {
+    const OrderLogEntry& e = log_[n];
+    router.restore_seen(e.order_id);
+    risk.on_fill(e.symbol, e.side, e.qty, e.px);
+    cur.order_seq = std::max(cur.order_seq, e.seq);
+    log_hash_ = mix_entry(log_hash_, e);
+    ++n; ++replayed;
+  }
+  log_len_ = n;
+  return best >= 0 || replayed > 0;
+}
+
+void StateFile::record_fill(uint64_t order_id, uint64_t seq, int sym, int side, int64_t qty, int64_t px) {
+  if (!is_open()) return;
+  if (log_len_ >= log_capacity_) {
+    ++log_dropped_;
+    ++reinterpret_cast<FileHeader*>(base_)->log_dropped; // a later restore must not trust the log
+    return;
+  }
+  OrderLogEntry& e = log_[log_len_++];
+  e.order_id = order_id;
+  e.symbol = sym;
+  e.side = side;
+  e.qty = qty;
+  e.px = px;
+  std::atomic_ref<uint64_t>(e.seq).store(seq, std::memory_order_release);
+  log_hash_ = mix_entry(log_hash_, e);
+}
+
+void StateFile::checkpoint(const Strategy& strat, const Risk& risk, const EngineCursor& cur) {
+  if (!is_open()) return;
+  // Never overwrite the last valid checkpoint: it must survive until this one is
+  // sealed. Without one, take the older slot, counting a corrupt slot as empty.
+  int target;
+  if (valid_slot_ >= 0) {
+    target = 1 - valid_slot_;
+  } else {
+    uint64_t g[2];
+    for (int i=0;i<2;++i) {
+      const SlotHeader* sh = reinterpret_cast<const SlotHeader*>(slot_ptr(i));
+      g[i] = sh->checksum == slot_checksum(slot_ptr(i)) ? sh->generation : 0;
+    }
+    target = g[0] <= g[1] ? 0 : 1;
+  }
+  unsigned char* s = slot_ptr(target);
+  SlotHeader* sh = reinterpret_cast<SlotHeader*>(s);
+  strat.save_state(slot_array<int64_t>(s, symbols_, 0), slot_array<double>(s, symbols_, 1), slot_array<double>(s, symbols_, 2));
+  Money pnl = 0; uint64_t blocks = 0;
+  risk.save_state(slot_array<int64_t>(s, symbols_, 3), pnl, blocks);
+  sh->pnl = pnl;
+  sh->exposure_blocks = blocks;
+  sh->events = cur.events;
+  sh->order_seq = cur.order_seq;
+  sh->log_len = log_len_;
+  sh->log_hash = log_hash_;
+  sh->generation = ++generation_;
+  std::atomic_thread_fence(std::memory_order_release);
+  sh->checksum = slot_checksum(s);
+  valid_slot_ = target;
+  ++checkpoints_;
+}
+
+void StateFile::close() {
+#ifdef NHFT_HAVE_MMAP
+  if (base_) {
+    msync(base_, bytes_, MS_SYNC);
+    munmap(base_, bytes_);
+    base_ = nullptr;
+    log_ = nullptr;
+  }
+  if (fd_ >= 0) { ::close(fd_); fd_ = -1; }
+#endif
+}
+
+} // namespace nhft
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "price.hpp"
+
+namespace nhft {
+
+class Strategy;
+class Risk;
+class Router;
+
+// Engine-wide counters saved alongside component state
+struct EngineCursor {
+  uint64_t events = 0;    // events processed by the primary consumer
+  uint64_t order_seq = 0; // last order sequence used for order IDs
+};
+
+// One routed fill in the state file's append-only order log. seq is written
+// last and doubles as the commit marker: an entry with seq == 0 is incomplete.
+struct OrderLogEntry {
+  uint64_t order_id;
+  int32_t symbol;
+  int32_t side;
+  int64_t qty;
+  int64_t px; // ticks
+  uint64_t seq;
+};
+
+// Versioned, memory-mapped engine state for warm restarts (POSIX only).
+//
+// Layout: header | slot A | slot B | order log.
+// Each slot holds Strategy EWMA/EWVAR state, Risk positions/PnL and the engine
+// cursor, sealed by a generation number and an FNV-1a checksum. checkpoint()
+// writes the slot restore() did not pick (otherwise the older or corrupt one)
+// and bumps its generation, so a crash mid-write leaves the last valid slot
+// intact; restore() picks the newest slot whose checksum holds.
+// Fills are appended to the order log as they are routed; each slot records how
+// many were committed and a rolling hash over them. Entries logged after the
+// newest checkpoint are replayed into Risk and the router on restore, so
+// positions and idempotency survive; strategy state reverts to the checkpoint.
+class StateFile {
+public:
+  static constexpr uint32_t kVersion = 2; // 2: integer ticks, positions and Money
+
+  StateFile() = default;
+  ~StateFile();
+  StateFile(const StateFile&) = delete;
+  StateFile& operator=(const StateFile&) = delete;
+
+  // Map (creating or resizing as needed) the state file at path for ticks.symbols()
+  // symbols. A file with a different version, symbol count, tick sizes or log
+  // capacity is reinitialized (cold): its positions and prices are in other ticks.
+  bool open(const std::string& path, const TickTable& ticks, size_t log_capacity = 1u << 18);
+  bool is_open() const { return base_ != nullptr; }
+
+  // True if a valid checkpoint was found; fills the components and cursor.
+  // The router should be freshly constructed (its seen set is rebuilt from the log).
+  // A file whose order log ever dropped a fill is reinitialized and restores nothing.
+  bool restore(Strategy& strat, Risk& risk, Router& router, EngineCursor& cur);
+
+  // Append a routed fill to the order log. Once the log is full the fill is
+  // counted as dropped, and the file is marked so the next restore starts cold.
+  void record_fill(uint64_t order_id, uint64_t seq, int sym, int side, int64_t qty, int64_t px);
+
+  // Seal the current state into the slot not holding the last valid checkpoint; never allocates
+  void checkpoint(const Strategy& strat, const Risk& risk, const EngineCursor& cur);
+
+  // Flush dirty pages to disk and unmap
+  void close();
+
+  uint64_t checkpoints() const { return checkpoints_; }
+  uint64_t log_dropped() const { return log_dropped_; } // this session
+
+private:
+  unsigned char* slot_ptr(int i) const;
+  uint64_t slot_checksum(const unsigned char* slot) const;
+
+  unsigned char* base_ = nullptr;
+  size_t bytes_ = 0;
+  int fd_ = -1;
+  int symbols_ = 0;
+  size_t slot_bytes_ = 0;
+  size_t log_capacity_ = 0;
+  OrderLogEntry* log_ = nullptr;
+  size_t log_len_ = 0;
+  uint64_t log_hash_ = 0;
+  uint64_t log_dropped_ = 0;
+  uint64_t generation_ = 0;
+  uint64_t checkpoints_ = 0;
+  int valid_slot_ = -1; // slot holding the last restored or written checkpoint
+};
+
+} // namespace nhft
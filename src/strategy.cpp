@@ -4,11 +4,11 @@
 namespace nhft {
 
 Strategy::Strategy(int symbols, double alpha, double z_entry)
-  : S_(symbols), alpha_(alpha), z_entry_(z_entry), prev_mid_(symbols, 0.0), ewma_(symbols, 0.0), ewvar_(symbols, 1e-6) {}
+  : S_(symbols), alpha_(alpha), z_entry_(z_entry), prev_mid_(symbols, 0), ewma_(symbols, 0.0), ewvar_(symbols, 1e-6) {}
 
-Decision Strategy::on_mid(int sym, double mid) {
+Decision Strategy::on_mid(int sym, int64_t mid) {
   double ret = 0.0;
-  if (prev_mid_[sym] > 0) ret = (mid - prev_mid_[sym]) / prev_mid_[sym];
+  if (prev_mid_[sym] > 0) ret = (double)(mid - prev_mid_[sym]) / (double)prev_mid_[sym];
   prev_mid_[sym] = mid;
   // EWMA and EWVAR
   double d = ret - ewma_[sym];
@@ -17,10 +17,18 @@ Decision Strategy::on_mid(int sym, double mid) {
   double z = (ewvar_[sym] > 1e-12) ? (ewma_[sym] / std::sqrt(ewvar_[sym])) : 0.0;
   Decision dec{};
   dec.reason_score = z;
-  if (z <= -z_entry_) { dec.side = +1; dec.qty = 1.0; }
-  else if (z >= +z_entry_) { dec.side = -1; dec.qty = 1.0; }
-  else { dec.side = 0; dec.qty = 0.0; }
+  if (z <= -z_entry_) { dec.side = +1; dec.qty = 1; }
+  else if (z >= +z_entry_) { dec.side = -1; dec.qty = 1; }
+  else { dec.side = 0; dec.qty = 0; }
   return dec;
 }
 
+void Strategy::save_state(int64_t* prev_mid, double* ewma, double* ewvar) const {
+  for (int i=0;i<S_;++i) { prev_mid[i] = prev_mid_[i]; ewma[i] = ewma_[i]; ewvar[i] = ewvar_[i]; }
+}
+
+void Strategy::load_state(const int64_t* prev_mid, const double* ewma, const double* ewvar) {
+  for (int i=0;i<S_;++i) { prev_mid_[i] = prev_mid[i]; ewma_[i] = ewma[i]; ewvar_[i] = ewvar[i]; }
+}
+
 } // namespace nhft
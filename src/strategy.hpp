@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <vector>
 
 namespace nhft {
@@ -6,19 +7,25 @@ namespace nhft {
 struct Decision {
   // -1 sell, 0 hold, +1 buy
   int side = 0;
-  double qty = 0; // units
+  int32_t qty = 0; // units
   double reason_score = 0; // for logging excerpt
 };
 
 class Strategy {
 public:
   Strategy(int symbols, double alpha=0.2, double z_entry=1.5);
-  Decision on_mid(int sym, double mid);
+  // mid in any fixed integer unit per symbol (the engine passes half-ticks);
+  // only relative changes matter
+  Decision on_mid(int sym, int64_t mid);
+  int symbols() const { return S_; }
+  // Raw per-symbol state (symbols() entries each) for checkpoint/restore
+  void save_state(int64_t* prev_mid, double* ewma, double* ewvar) const;
+  void load_state(const int64_t* prev_mid, const double* ewma, const double* ewvar);
 private:
   int S_;
   double alpha_;
   double z_entry_;
-  std::vector<double> prev_mid_;
+  std::vector<int64_t> prev_mid_;
   std::vector<double> ewma_;
   std::vector<double> ewvar_;
 };
@@ -0,0 +1,53 @@
+#include "stream_hash.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace nhft {
+
+StreamHasher::StreamHasher(uint64_t checkpoint_every, uint64_t capture_begin, uint64_t capture_end)
+  : every_(checkpoint_every ? checkpoint_every : 1), capture_begin_(capture_begin), capture_end_(capture_end) {
+  checkpoints_.reserve(1024);
+  if (capture_end_ > capture_begin_) captured_.reserve((size_t)(capture_end_ - capture_begin_));
+}
+
+DivergenceWindow first_divergent_window(const StreamHasher& a, const StreamHasher& b) {
+  DivergenceWindow w;
+  const auto& ca = a.checkpoints();
+  const auto& cb = b.checkpoints();
+  size_t n = std::min(ca.size(), cb.size());
+  uint64_t prev = 0;
+  for (size_t i=0;i<n;++i) {
+    if (ca[i].events != cb[i].events || ca[i].hash != cb[i].hash) {
+      w.found = true; w.begin = prev; w.end = std::max(ca[i].events, cb[i].events);
+      return w;
+    }
+    prev = ca[i].events;
+  }
+  if (ca.size() != cb.size()) {
+    // One run saw more events: the first extra interval is where they part ways
+    w.found = true; w.begin = prev; w.end = std::max(a.events(), b.events());
+  }
+  return w;
+}
+
+long first_divergent_event(const StreamHasher& a, const StreamHasher& b) {
+  const auto& xa = a.captured();
+  const auto& xb = b.captured();
+  size_t n = std::min(xa.size(), xb.size());
+  for (size_t i=0;i<n;++i) {
+    if (xa[i].hash != xb[i].hash || xa[i].ev.index != xb[i].ev.index) return (long)i;
+  }
+  return xa.size() != xb.size() ? (long)n : -1;
+}
+
+std::string stream_event_json(const StreamEvent& e) {
+  std::ostringstream oss;
+  oss << std::setprecision(17);
+  oss << "{ \"index\": " << e.index << ", \"ts_ns\": " << e.ts_ns << ", \"symbol\": " << e.symbol
+      << ", \"mid2\": " << e.mid2 << ", \"side\": " << e.side << ", \"score\": " << e.score
+      << ", \"risk\": " << e.risk << ", \"filled\": " << e.filled << ", \"pnl\": " << e.pnl << " }";
+  return oss.str();
+}
+
+} // namespace nhft
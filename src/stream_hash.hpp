@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace nhft {
+
+// Engine state after one event, as folded into the stream hash
+struct StreamEvent {
+  uint64_t index;   // consumer-side event index
+  uint64_t ts_ns;   // production timestamp
+  int32_t symbol;
+  int32_t side;     // decision: -1/0/+1
+  int64_t mid2;     // mid in half-ticks
+  double score;     // strategy z-score
+  int32_t risk;     // FlightRisk code (0 = no order)
+  int32_t filled;   // 1 if an order was routed
+  int64_t pnl;      // Risk PnL after the event (Money)
+};
+
+struct StreamCheckpoint {
+  uint64_t events; // events folded in so far
+  uint64_t hash;
+};
+
+// Rolling hash over the event/decision/fill stream of one run. Records the hash
+// every checkpoint_every events, and optionally keeps the per-event state (with
+// its running hash) for events in [capture_begin, capture_end) so a divergence
+// found at checkpoint granularity can be pinned to a single event on a rerun.
+class StreamHasher {
+public:
+  explicit StreamHasher(uint64_t checkpoint_every = 1024, uint64_t capture_begin = 0, uint64_t capture_end = 0);
+
+  void on_event(const StreamEvent& e) {
+    h_ = mix(h_, e.index); h_ = mix(h_, e.ts_ns);
+    h_ = mix(h_, (uint64_t)(uint32_t)e.symbol | ((uint64_t)(uint32_t)e.side << 32));
+    h_ = mix(h_, (uint64_t)e.mid2); h_ = mix(h_, bits(e.score));
+    h_ = mix(h_, (uint64_t)(uint32_t)e.risk | ((uint64_t)(uint32_t)e.filled << 32));
+    h_ = mix(h_, (uint64_t)e.pnl);
+    ++n_;
+    if (e.index >= capture_begin_ && e.index < capture_end_) captured_.push_back({e, h_});
+    if (n_ % every_ == 0) checkpoints_.push_back({n_, h_});
+  }
+  // Record a trailing checkpoint for a partial final interval
+  void finish() { if (checkpoints_.empty() || checkpoints_.back().events != n_) checkpoints_.push_back({n_, h_}); }
+
+  uint64_t hash() const { return h_; }
+  uint64_t events() const { return n_; }
+  uint64_t checkpoint_every() const { return every_; }
+  const std::vector<StreamCheckpoint>& checkpoints() const { return checkpoints_; }
+
+  struct Captured { StreamEvent ev; uint64_t hash; };
+  const std::vector<Captured>& captured() const { return captured_; }
+
+private:
+  static uint64_t bits(double d) { uint64_t u; static_assert(sizeof(u) == sizeof(d)); std::memcpy(&u, &d, sizeof(u)); return u; }
+  static uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    h ^= h >> 33; h *= 0xFF51AFD7ED558CCDull; h ^= h >> 33;
+    return h;
+  }
+
+  uint64_t every_;
+  uint64_t capture_begin_, capture_end_;
+  uint64_t h_ = 0;
+  uint64_t n_ = 0;
+  std::vector<StreamCheckpoint> checkpoints_;
+  std::vector<Captured> captured_;
+};
+
+// Event range [begin, end) that contains the first divergence between two runs,
+// or found == false if their checkpoint sequences are identical
+struct DivergenceWindow {
+  bool found = false;
+  uint64_t begin = 0;
+  uint64_t end = 0;
+};
+DivergenceWindow first_divergent_window(const StreamHasher& a, const StreamHasher& b);
+
+// Index of the first captured event whose running hash differs (-1 if none)
+long first_divergent_event(const StreamHasher& a, const StreamHasher& b);
+
+// JSON object describing a StreamEvent
+std::string stream_event_json(const StreamEvent& e);
+
+} // namespace nhft
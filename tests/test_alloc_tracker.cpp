@@ -0,0 +1,41 @@
+#include <catch2/catch_amalgamated.hpp>
+#include "alloc_tracker.hpp"
+#include "id_set.hpp"
+#include <memory>
+
+using namespace nhft;
+
+TEST_CASE("Allocation tracker attributes allocations to the thread's phase", "[alloc]") {
+  if (!alloc_tracking_enabled()) return;
+  AllocPhase prev = alloc_phase();
+  alloc_set_phase(AllocPhase::hot);
+  auto a0 = alloc_thread_stats();
+  auto p = std::make_unique<char[]>(100);
+  p[0] = 1;
+  auto a1 = alloc_thread_stats();
+  alloc_set_phase(prev);
+  REQUIRE(alloc_diff(a0, a1, AllocPhase::hot).allocs == 1);
+  REQUIRE(alloc_diff(a0, a1, AllocPhase::hot).bytes == 100);
+  REQUIRE(alloc_diff(a0, a1, AllocPhase::warmup).allocs == 0);
+}
+
+TEST_CASE("IdSet inserts without allocating below half load", "[alloc]") {
+  IdSet s(1u << 12);
+  AllocPhase prev = alloc_phase();
+  alloc_set_phase(AllocPhase::hot);
+  auto a0 = alloc_thread_stats();
+  for (uint64_t i=0;i<2000;++i) REQUIRE(s.insert(i * 7919));
+  REQUIRE(s.insert(7919) == false);
+  REQUIRE(s.contains(0));
+  REQUIRE(!s.contains(1));
+  auto a1 = alloc_thread_stats();
+  alloc_set_phase(prev);
+  REQUIRE(alloc_diff(a0, a1, AllocPhase::hot).allocs == 0);
+  REQUIRE(s.grows() == 0);
+  // Growing past half load rehashes (and counts it) but keeps every ID
+  for (uint64_t i=2000;i<5000;++i) s.insert(i * 7919);
+  REQUIRE(s.size() == 5000);
+  REQUIRE(s.capacity() > (1u << 12));
+  REQUIRE(s.grows() > 0);
+  for (uint64_t i=0;i<5000;++i) REQUIRE(s.contains(i * 7919));
+}
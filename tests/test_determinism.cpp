@@ -1,4 +1,5 @@
 #include <catch2/catch_amalgamated.hpp>
+#include "stream_hash.hpp"
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -12,9 +13,57 @@ static std::string slurp(const std::string& path) {
 TEST_CASE("Determinism check produces identical checksums", "[det]") {
   // Run the nanohft binary with determinism-check for 3 seconds to out/det
   // Assume working dir is the build directory where the binary resides
-  std::string cmd = std::string("./nanohft --determinism-check --duration-s 3 --report out/det > /dev/null 2>&1");
+  std::string cmd = std::string("./nanohft --determinism-check --det-runs 4 --duration-s 3 --report out/det > /dev/null 2>&1");
   int rc = std::system(cmd.c_str());
   REQUIRE(rc == 0);
   std::string content = slurp("out/det/determinism_result.json");
   REQUIRE(content.find("\"pass\": true") != std::string::npos);
+  REQUIRE(content.find("\"divergence\": null") != std::string::npos);
+}
+
+TEST_CASE("Determinism check hashes every event of the run", "[det]") {
+  // Far more events than the 16K ring: the deterministic producer must not drop
+  auto events = [](int secs) {
+    std::string dir = "out/det_len" + std::to_string(secs);
+    std::string cmd = "./nanohft --determinism-check --det-runs 2 --rate 50000 --duration-s " + std::to_string(secs)
+                    + " --report " + dir + " > /dev/null 2>&1";
+    REQUIRE(std::system(cmd.c_str()) == 0);
+    std::string content = slurp(dir + "/determinism_result.json");
+    auto at = content.find("\"events\": ");
+    REQUIRE(at != std::string::npos);
+    return std::stoull(content.substr(at + 10));
+  };
+  uint64_t one = events(1), three = events(3);
+  REQUIRE(one == 50000);
+  REQUIRE(three == 150000);
+  REQUIRE(slurp("out/det_len3/run0/metrics.json").find("\"drops\": 0,") != std::string::npos);
+}
+
+TEST_CASE("Stream hash pinpoints the first diverging event", "[det]") {
+  using namespace nhft;
+  auto feed = [](StreamHasher& h, uint64_t bad) {
+    for (uint64_t i=0;i<5000;++i) {
+      StreamEvent e{i, 1000*i, (int32_t)(i%8), (int32_t)(i%3)-1, 20000 + (int64_t)i, 0.5, 1, 0, 0};
+      if (i == bad) e.pnl = 1;
+      h.on_event(e);
+    }
+    h.finish();
+  };
+  StreamHasher a(256), b(256);
+  feed(a, ~0ull); feed(b, 3001);
+  REQUIRE(a.hash() != b.hash());
+  auto w = first_divergent_window(a, b);
+  REQUIRE(w.found);
+  REQUIRE(w.begin == 2816);
+  REQUIRE(w.end == 3072);
+
+  StreamHasher ra(256, w.begin, w.end), rb(256, w.begin, w.end);
+  feed(ra, ~0ull); feed(rb, 3001);
+  long at = first_divergent_event(ra, rb);
+  REQUIRE(at == 3001 - 2816);
+  REQUIRE(rb.captured()[at].ev.index == 3001);
+
+  StreamHasher c(256);
+  feed(c, ~0ull);
+  REQUIRE(!first_divergent_window(a, c).found);
 }
@@ -0,0 +1,60 @@
+#include <catch2/catch_amalgamated.hpp>
+#include "flight_recorder.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace nhft;
+
+static FlightEvent ev_at(uint64_t seq, uint64_t lat_ns) {
+  FlightEvent e{};
+  e.seq = seq; e.ts_ns = seq * 1000; e.done_ns = e.ts_ns + lat_ns; e.symbol = (int32_t)(seq % 4);
+  e.dequeue_ns = e.ts_ns + lat_ns / 4; e.strategy_ns = e.ts_ns + lat_ns / 2; // stages survive the dump
+  return e;
+}
+
+TEST_CASE("Flight recorder dumps the window around a latency outlier", "[flight]") {
+  namespace fs = std::filesystem;
+  std::string dir = "out/flight_test";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  {
+    FlightRecorder fr(64, /*threshold_ns*/ 5000, dir);
+    for (uint64_t i=0;i<1000;++i) fr.record(ev_at(i, i == 500 ? 9000 : 100));
+    fr.finish();
+    REQUIRE(fr.dumps_written() == 1);
+  }
+  std::ifstream f(dir + "/flight_0.bin", std::ios::binary);
+  REQUIRE(f.good());
+  FlightDumpHeader h{};
+  f.read(reinterpret_cast<char*>(&h), sizeof(h));
+  REQUIRE(std::memcmp(h.magic, "NHFTFR1", 8) == 0);
+  REQUIRE(h.version == 3);
+  REQUIRE(h.record_size == sizeof(FlightEvent));
+  REQUIRE(h.count == 64);
+  REQUIRE(h.trigger_seq == 500);
+  std::vector<FlightEvent> evs(h.count);
+  f.read(reinterpret_cast<char*>(evs.data()), (std::streamsize)(h.count * sizeof(FlightEvent)));
+  // Outlier sits in the middle of a contiguous, oldest-first window
+  REQUIRE(evs.front().seq == 469);
+  REQUIRE(evs.back().seq == 532);
+  for (size_t i=1;i<evs.size();++i) REQUIRE(evs[i].seq == evs[i-1].seq + 1);
+  const FlightEvent& out = evs[500 - 469];
+  REQUIRE(out.dequeue_ns == out.ts_ns + 2250);
+  REQUIRE(out.strategy_ns == out.ts_ns + 4500);
+}
+
+TEST_CASE("Flight recorder snapshots on signal request", "[flight]") {
+  namespace fs = std::filesystem;
+  std::string dir = "out/flight_test_sig";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  FlightRecorder fr(16, /*threshold_ns*/ 0, dir);
+  for (uint64_t i=0;i<100;++i) fr.record(ev_at(i, 100));
+  flight_request_snapshot();
+  for (uint64_t i=100;i<200;++i) fr.record(ev_at(i, 100));
+  fr.finish();
+  REQUIRE(fr.dumps_written() == 1);
+  REQUIRE(fs::exists(dir + "/flight_0.bin"));
+}
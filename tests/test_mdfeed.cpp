@@ -0,0 +1,112 @@
+#include <catch2/catch_amalgamated.hpp>
+#include "mdfeed.hpp"
+#include "rng.hpp"
+#include <cmath>
+#include <vector>
+
+using namespace nhft;
+
+TEST_CASE("Philox4x32-10 matches the Random123 known-answer vectors", "[feed]") {
+  uint32_t out[4];
+  const uint32_t zero[4] = {0, 0, 0, 0};
+  Philox4x32::block(zero, 0, 0, out);
+  REQUIRE(out[0] == 0x6627e8d5u); REQUIRE(out[1] == 0xe169c58du);
+  REQUIRE(out[2] == 0xbc57ac4cu); REQUIRE(out[3] == 0x9b00dbd8u);
+  const uint32_t pi[4] = {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u};
+  Philox4x32::block(pi, 0xa4093822u, 0x299f31d0u, out);
+  REQUIRE(out[0] == 0xd16cfe09u); REQUIRE(out[1] == 0x94fdccebu);
+  REQUIRE(out[2] == 0x5001e420u); REQUIRE(out[3] == 0x24126ea1u);
+
+  // The laned fill agrees with the scalar block, including the ragged tail
+  Philox4x32 rng(0x0123456789abcdefull);
+  std::vector<uint32_t> words(4 * 21);
+  rng.fill(1000, 3, words.data(), 21);
+  for (uint32_t i=0;i<21;++i) {
+    const uint32_t ctr[4] = {1000 + i, 0, 3, 0};
+    Philox4x32::block(ctr, rng.key0(), rng.key1(), out);
+    for (int k=0;k<4;++k) REQUIRE(words[4*i + k] == out[k]);
+  }
+}
+
+TEST_CASE("Feed is deterministic per seed and independent of batch size", "[feed]") {
+  FeedConfig cfg;
+  cfg.zipf = 1.1; cfg.corr = 0.5; cfg.vol = {0.02, 0.01};
+  MdFeed a(8, 1000, 42, {}, true, cfg), b(8, 1000, 42, {}, true, cfg), c(8, 1000, 43, {}, true, cfg);
+  std::vector<MdEvent> batch(1000);
+  b.next(0.0); // leave a partially consumed buffer behind
+  b.next_batch(0.0, batch.data(), batch.size());
+  a.next(0.0);
+  bool differs = false;
+  for (size_t i=0;i<batch.size();++i) {
+    MdEvent e = a.next(0.0);
+    REQUIRE(e.symbol == batch[i].symbol);
+    REQUIRE(e.bid == batch[i].bid);
+    if (c.next(0.0).bid != e.bid) differs = true;
+  }
+  REQUIRE(differs);
+}
+
+TEST_CASE("Zipf popularity skews symbols; zero exponent keeps round-robin", "[feed]") {
+  FeedConfig cfg;
+  cfg.zipf = 1.0;
+  MdFeed z(8, 1000, 7, {}, true, cfg);
+  std::vector<int> hits(8, 0);
+  const int N = 80000;
+  for (int i=0;i<N;++i) hits[z.next(0.0).symbol]++;
+  // p_0 = 1 / H_8 ~= 0.368, p_7 ~= 0.046
+  REQUIRE(hits[0] > N * 0.34); REQUIRE(hits[0] < N * 0.40);
+  REQUIRE(hits[7] > N * 0.03); REQUIRE(hits[7] < N * 0.06);
+  for (int k=1;k<8;++k) REQUIRE(hits[k] < hits[k-1]);
+
+  MdFeed rr(4, 1000, 7, {});
+  for (int i=0;i<12;++i) REQUIRE(rr.next(0.0).symbol == i % 4);
+}
+
+TEST_CASE("Correlated bursts move symbols together", "[feed]") {
+  // Inside the burst every move shares the market factor; outside they are independent.
+  // Kept short so the walk stays far above the one-tick floor.
+  std::vector<Burst> bursts{Burst{1.0, 1.0, 1.0, 1.0}};
+  MdFeed f(2, 1000, 7, bursts, true);
+  auto corr = [&](double t) {
+    double sxy = 0, sxx = 0, syy = 0;
+    double prev[2] = {(double)f.next(t).mid2(), (double)f.next(t).mid2()};
+    for (int i=0;i<4000;++i) {
+      MdEvent x = f.next(t), y = f.next(t); // round-robin: symbol 0 then 1, same factor tick
+      double rx = x.mid2() / prev[0] - 1.0, ry = y.mid2() / prev[1] - 1.0;
+      prev[0] = (double)x.mid2(); prev[1] = (double)y.mid2();
+      sxy += rx * ry; sxx += rx * rx; syy += ry * ry;
+    }
+    return sxy / std::sqrt(sxx * syy);
+  };
+  REQUIRE(std::abs(corr(0.0)) < 0.1);
+  REQUIRE(corr(1.5) > 0.9);
+}
+
+TEST_CASE("Burst correlation takes effect at the edge, not at the next refill", "[feed]") {
+  std::vector<Burst> bursts{Burst{1.0, 1.0, 1.0, 1.0}};
+  MdFeed f(2, 1000, 7, bursts, true);
+  // Both calls before the burst: the buffer for the first kBatch events is already drawn
+  double prev[2] = {(double)f.next(0.0).mid2(), (double)f.next(0.0).mid2()};
+  double sxy = 0, sxx = 0, syy = 0;
+  for (size_t i=1;i<MdFeed::kBatch/2;++i) {
+    MdEvent x = f.next(1.5), y = f.next(1.5);
+    double rx = x.mid2() / prev[0] - 1.0, ry = y.mid2() / prev[1] - 1.0;
+    prev[0] = (double)x.mid2(); prev[1] = (double)y.mid2();
+    sxy += rx * ry; sxx += rx * rx; syy += ry * ry;
+  }
+  REQUIRE(sxy / std::sqrt(sxx * syy) > 0.9);
+}
+
+TEST_CASE("Events are 16-byte tick quotes on each symbol's grid", "[feed]") {
+  REQUIRE(sizeof(MdEvent) == 16);
+  TickTable ticks(2, {0.01, 0.05});
+  MdFeed f(2, 1000, 7, {}, true, FeedConfig{}, &ticks);
+  MdEvent a = f.next(0.0), b = f.next(0.0);
+  // Starting mids 100 and 101: one-tick-wide quotes around them
+  REQUIRE(a.symbol == 0); REQUIRE(a.spread == 1);
+  REQUIRE(std::abs(ticks.to_price(0, a.bid) - 100.0) < 1.5);
+  REQUIRE(b.symbol == 1);
+  REQUIRE(std::abs(ticks.to_price(1, b.bid) - 101.0) < 1.5);
+  REQUIRE(b.ask() == b.bid + 1);
+  REQUIRE(b.mid2() == 2 * (int64_t)b.bid + 1);
+}
@@ -0,0 +1,229 @@
+#include <catch2/catch_amalgamated.hpp>
+#include "alloc_tracker.hpp"
+#include "order_manager.hpp"
+
+using namespace nhft;
+
+namespace {
+
+struct Harness {
+  SpscRing<OrderRequest> to_gw{1u << 17};
+  SpscRing<GatewayEvent> from_gw{1u << 17};
+  SpscRing<OrderReport> reports{1u << 17};
+  OrderManager om;
+  explicit Harness(OrderManagerConfig cfg = {}) : om(cfg, to_gw, &reports) {}
+
+  OrderRequest request() { OrderRequest r{}; REQUIRE(to_gw.pop(r)); return r; }
+  void reply(uint64_t id, GatewayEventType t, int64_t qty = 0, uint64_t now = 0) {
+    REQUIRE(from_gw.push(GatewayEvent{id, now, qty, 0, t}));
+    om.poll(from_gw, now);
+  }
+  OrderState state(uint64_t id) { OrderState s{}; int64_t f = 0; REQUIRE(om.find(id, s, f)); return s; }
+};
+
+} // namespace
+
+TEST_CASE("Order lifecycle: ack, partial fills, fill", "[orders]") {
+  Harness h;
+  uint64_t id = h.om.submit(3, +1, 10, 12345, 0);
+  REQUIRE(id != 0);
+  OrderRequest r = h.request();
+  REQUIRE(r.type == RequestType::new_order);
+  REQUIRE(r.order_id == id);
+  REQUIRE(r.symbol == 3);
+  REQUIRE(r.qty == 10);
+  REQUIRE(h.state(id) == OrderState::pending_new);
+
+  h.reply(id, GatewayEventType::ack);
+  REQUIRE(h.state(id) == OrderState::live);
+  h.reply(id, GatewayEventType::fill, 4);
+  OrderState s{}; int64_t filled = 0;
+  REQUIRE(h.om.find(id, s, filled));
+  REQUIRE(filled == 4);
+  h.reply(id, GatewayEventType::fill, 6);
+  REQUIRE(!h.om.find(id, s, filled));
+  REQUIRE(h.om.live() == 0);
+
+  OrderReport rep{};
+  REQUIRE(h.reports.pop(rep));
+  REQUIRE(rep.order_id == id);
+  REQUIRE(rep.state == OrderState::filled);
+  REQUIRE(rep.filled == 10);
+  REQUIRE(h.om.stats().filled == 1);
+
+  // Late events for the finished order are ignored, and its slot gets a new ID
+  h.reply(id, GatewayEventType::fill, 1);
+  REQUIRE(h.om.stats().unknown_events == 1);
+  uint64_t id2 = h.om.submit(3, -1, 1, 12345, 0);
+  REQUIRE((uint32_t)id2 == (uint32_t)id);
+  REQUIRE(id2 != id);
+}
+
+TEST_CASE("Order lifecycle: reject, cancel, cancel reject", "[orders]") {
+  Harness h;
+  uint64_t a = h.om.submit(0, +1, 5, 100, 0);
+  h.reply(a, GatewayEventType::reject);
+  OrderReport rep{};
+  REQUIRE(h.reports.pop(rep));
+  REQUIRE(rep.state == OrderState::rejected);
+
+  uint64_t b = h.om.submit(0, -1, 5, 100, 0);
+  h.reply(b, GatewayEventType::ack);
+  REQUIRE(h.om.cancel(b, 0));
+  REQUIRE(h.state(b) == OrderState::pending_cancel);
+  h.request(); // new a
+  h.request(); // new b
+  REQUIRE(h.request().type == RequestType::cancel);
+  // Cancel refused: still working, and fills still count
+  h.reply(b, GatewayEventType::reject);
+  REQUIRE(h.state(b) == OrderState::live);
+  h.reply(b, GatewayEventType::fill, 2);
+  REQUIRE(h.om.cancel(b, 0));
+  h.reply(b, GatewayEventType::cancelled);
+  REQUIRE(h.reports.pop(rep));
+  REQUIRE(rep.order_id == b);
+  REQUIRE(rep.state == OrderState::cancelled);
+  REQUIRE(rep.filled == 2);
+  REQUIRE(!h.om.cancel(b, 0));
+}
+
+TEST_CASE("Order lifecycle: ack timeout, time in force, cancel before ack", "[orders]") {
+  OrderManagerConfig cfg;
+  cfg.ack_timeout_ns = 1000;
+  cfg.tif_ns = 5000;
+  Harness h(cfg);
+
+  uint64_t lost = h.om.submit(0, +1, 1, 100, 0);
+  uint64_t tif = h.om.submit(1, +1, 1, 100, 10);
+  h.reply(tif, GatewayEventType::ack, 0, 20);
+  h.om.poll(h.from_gw, 999);
+  REQUIRE(h.state(lost) == OrderState::pending_new);
+  // No ack: the new may still be working at the gateway, so the order stays tracked and is cancelled
+  h.om.poll(h.from_gw, 1000);
+  OrderReport rep{};
+  REQUIRE(!h.reports.pop(rep));
+  REQUIRE(h.state(lost) == OrderState::in_doubt);
+  REQUIRE(h.om.stats().in_doubt == 1);
+  h.request(); h.request();
+  OrderRequest c = h.request();
+  REQUIRE(c.type == RequestType::cancel);
+  REQUIRE(c.order_id == lost);
+  // Still silent: the cancel is resent every ack timeout
+  h.om.poll(h.from_gw, 2000);
+  REQUIRE(h.request().order_id == lost);
+  // The gateway never had it: final
+  h.reply(lost, GatewayEventType::reject, 0, 2001);
+  REQUIRE(h.reports.pop(rep));
+  REQUIRE(rep.order_id == lost);
+  REQUIRE(rep.state == OrderState::timed_out);
+
+  // Time in force runs from the ack; expiry sends a cancel
+  h.om.poll(h.from_gw, 5019);
+  REQUIRE(h.state(tif) == OrderState::live);
+  h.om.poll(h.from_gw, 5020);
+  REQUIRE(h.state(tif) == OrderState::pending_cancel);
+  c = h.request();
+  REQUIRE(c.type == RequestType::cancel);
+  REQUIRE(c.order_id == tif);
+  // No cancel confirmation either: in doubt, and a late fill still lands on the order
+  h.om.poll(h.from_gw, 6020);
+  REQUIRE(h.state(tif) == OrderState::in_doubt);
+  REQUIRE(h.request().order_id == tif);
+  h.reply(tif, GatewayEventType::fill, 1, 6030);
+  REQUIRE(h.reports.pop(rep));
+  REQUIRE(rep.order_id == tif);
+  REQUIRE(rep.state == OrderState::filled);
+  REQUIRE(h.om.stats().unknown_events == 0);
+  REQUIRE(h.om.stats().timed_out == 1);
+
+  // A cancel requested before the ack goes out once the order is acked
+  uint64_t early = h.om.submit(2, -1, 1, 100, 7000);
+  h.request();
+  REQUIRE(h.om.cancel(early, 7001));
+  OrderRequest none{};
+  REQUIRE(!h.to_gw.pop(none));
+  h.reply(early, GatewayEventType::ack, 0, 7002);
+  REQUIRE(h.request().type == RequestType::cancel);
+  REQUIRE(h.om.live() == 1);
+}
+
+TEST_CASE("Order acked after its timeout is cancelled, not forgotten", "[orders]") {
+  OrderManagerConfig cfg;
+  cfg.ack_timeout_ns = 1000;
+  Harness h(cfg);
+  uint64_t id = h.om.submit(0, +1, 3, 100, 0);
+  h.request();
+  h.om.poll(h.from_gw, 1000);
+  REQUIRE(h.request().type == RequestType::cancel);
+  h.reply(id, GatewayEventType::ack, 0, 1001);
+  REQUIRE(h.state(id) == OrderState::pending_cancel);
+  h.reply(id, GatewayEventType::fill, 1, 1002);
+  h.reply(id, GatewayEventType::cancelled, 0, 1003);
+  OrderReport rep{};
+  REQUIRE(h.reports.pop(rep));
+  REQUIRE(rep.state == OrderState::cancelled);
+  REQUIRE(rep.filled == 1);
+  REQUIRE(h.om.live() == 0);
+}
+
+TEST_CASE("Order manager counts dropped reports and oversized frames apart from a full pool", "[orders]") {
+  SpscRing<OrderRequest> to_gw(1024);
+  SpscRing<GatewayEvent> from_gw(1024);
+  SpscRing<OrderReport> reports(2);
+  OrderManager om(OrderManagerConfig{}, to_gw, &reports);
+  const size_t n = 8;
+  for (size_t i=0;i<n;++i) {
+    uint64_t id = om.submit(0, +1, 1, 100, 0);
+    REQUIRE(from_gw.push(GatewayEvent{id, 0, 0, 0, GatewayEventType::reject}));
+  }
+  om.poll(from_gw, 0);
+  size_t kept = 0;
+  OrderReport rep{};
+  while (reports.pop(rep)) ++kept;
+  REQUIRE(kept < n);
+  REQUIRE(om.stats().reports_dropped == n - kept);
+
+  OrderManagerConfig tiny;
+  tiny.frame_bytes = 16;
+  OrderManager small(tiny, to_gw);
+  REQUIRE(small.submit(0, +1, 1, 100, 0) == 0);
+  REQUIRE(small.stats().frame_too_large == 1);
+  REQUIRE(small.stats().pool_full == 0);
+}
+
+TEST_CASE("Order manager keeps tens of thousands of orders live without allocating", "[orders]") {
+  OrderManagerConfig cfg;
+  cfg.max_orders = 50000;
+  Harness h(cfg);
+  std::vector<uint64_t> ids(cfg.max_orders);
+
+  AllocPhase prev = alloc_phase();
+  alloc_set_phase(AllocPhase::hot);
+  auto a0 = alloc_thread_stats();
+  for (uint32_t i=0;i<cfg.max_orders;++i) {
+    ids[i] = h.om.submit((int)(i % 64), (i & 1) ? 1 : -1, 2, 100 + i, i);
+    REQUIRE(ids[i] != 0);
+  }
+  REQUIRE(h.om.submit(0, 1, 1, 1, 0) == 0);
+  REQUIRE(h.om.stats().pool_full == 1);
+  REQUIRE(h.om.live() == cfg.max_orders);
+  // Ack everything, then fill in reverse order
+  OrderRequest r{};
+  while (h.to_gw.pop(r)) {
+    h.from_gw.push(GatewayEvent{r.order_id, 0, 0, 0, GatewayEventType::ack});
+    if (h.from_gw.depth() == 4096) while (h.om.poll(h.from_gw, cfg.max_orders, 4096)) {}
+  }
+  while (h.om.poll(h.from_gw, cfg.max_orders)) {}
+  for (size_t i=ids.size(); i-- > 0;) {
+    h.from_gw.push(GatewayEvent{ids[i], 0, 2, 0, GatewayEventType::fill});
+    if (h.from_gw.depth() == 4096) while (h.om.poll(h.from_gw, cfg.max_orders, 4096)) {}
+  }
+  while (h.om.poll(h.from_gw, cfg.max_orders)) {}
+  auto a1 = alloc_thread_stats();
+  alloc_set_phase(prev);
+
+  REQUIRE(h.om.live() == 0);
+  REQUIRE(h.om.stats().filled == cfg.max_orders);
+  REQUIRE(h.om.stats().unknown_events == 0);
+  if (alloc_tracking_enabled()) REQUIRE(alloc_diff(a0, a1, AllocPhase::hot).allocs == 0);
+}
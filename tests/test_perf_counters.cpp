@@ -0,0 +1,46 @@
+#include <catch2/catch_amalgamated.hpp>
+#include "perf_counters.hpp"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace nhft;
+
+TEST_CASE("Perf counters degrade gracefully and count page faults when permitted", "[perf]") {
+  PerfCounters pc;
+  if (!pc.open()) {
+    // Not permitted here: reads must still be well-formed and empty
+    PerfSample s = pc.read();
+    for (int i=0;i<kPerfEvents;++i) REQUIRE(!s.valid[i]);
+    REQUIRE(!pc.has_rdpmc());
+    return;
+  }
+  pc.start();
+  std::vector<char> touch(8u << 20);
+  for (size_t i=0;i<touch.size();i+=4096) touch[i] = 1;
+  pc.stop();
+  PerfSample s = pc.read();
+  if (pc.available(PerfEvent::page_faults)) {
+    REQUIRE(s.valid[(int)PerfEvent::page_faults]);
+    REQUIRE(s.value[(int)PerfEvent::page_faults] > 0);
+  }
+  if (pc.available(PerfEvent::cycles)) {
+    REQUIRE(s.valid[(int)PerfEvent::cycles]);
+    REQUIRE(s.value[(int)PerfEvent::cycles] > 0);
+  }
+}
+
+TEST_CASE("Context switches are counted, or reported unavailable", "[perf]") {
+  PerfCounters pc;
+  pc.open();
+  pc.start();
+  for (int i=0;i<5;++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  pc.stop();
+  PerfSample s = pc.read();
+  if (pc.available(PerfEvent::context_switches)) {
+    REQUIRE(s.valid[(int)PerfEvent::context_switches]);
+    REQUIRE(s.value[(int)PerfEvent::context_switches] > 0);
+  } else {
+    REQUIRE(!s.valid[(int)PerfEvent::context_switches]);
+  }
+}
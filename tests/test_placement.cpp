@@ -0,0 +1,29 @@
+#include <catch2/catch_amalgamated.hpp>
+#include "placement.hpp"
+
+using namespace nhft;
+
+TEST_CASE("Placement spec maps roles to CPUs", "[placement]") {
+  PlacementSpec p;
+  REQUIRE(p.parse("feed=2,engine=4,shadow=5,shadow=7,journal=6"));
+  REQUIRE(p.cpu_for("feed") == 2);
+  REQUIRE(p.cpu_for("engine") == 4);
+  REQUIRE(p.cpu_for("journal") == 6);
+  REQUIRE(p.cpu_for("shadow", 0) == 5);
+  REQUIRE(p.cpu_for("shadow", 1) == 7);
+  REQUIRE(p.cpu_for("shadow", 2) == -1);
+  REQUIRE(p.cpu_for("unknown") == -1);
+  // Malformed specs are rejected without clobbering the previous placement
+  REQUIRE(p.parse("feed=x") == false);
+  REQUIRE(p.parse("engine") == false);
+  REQUIRE(p.parse("feed=1,egnine=3") == false); // unknown role
+  REQUIRE(p.parse("feed=99999999999") == false); // overflows int
+  REQUIRE(p.parse("feed=100000") == false);      // beyond any cpu_set_t
+  REQUIRE(p.cpu_for("feed") == 2);
+  // set() overrides the first thread of a role
+  p.set("engine", 9);
+  REQUIRE(p.cpu_for("engine") == 9);
+  p.set("shadow", 1);
+  REQUIRE(p.cpu_for("shadow", 0) == 1);
+  REQUIRE(p.cpu_for("shadow", 1) == 7);
+}
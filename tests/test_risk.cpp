@@ -4,19 +4,32 @@
 using namespace nhft;
 
 TEST_CASE("Risk gating triggers on caps", "[risk]") {
-  Risk r(2, /*per_trade_cap*/ 10.0, /*daily_loss_cap*/ 1.0);
+  TickTable ticks(2); // 0.01 per tick
+  Risk r(ticks, /*per_trade_cap*/ 10 * kMoneyPerUnit, /*daily_loss_cap*/ 1 * kMoneyPerUnit);
   // per-trade notional cap breach
-  auto rr1 = r.check(0, +1, 2.0, 6.0); // notional=12 > 10
+  auto rr1 = r.check(0, +1, 2, 600); // notional=12 > 10
   REQUIRE(rr1.allowed == false);
   REQUIRE(r.exposure_blocks() >= 1);
 
   // allowed trade then accumulate losses
-  auto rr2 = r.check(0, +1, 1.0, 5.0); // notional=5 <= 10
+  auto rr2 = r.check(0, +1, 1, 500); // notional=5 <= 10
   REQUIRE(rr2.allowed == true);
-  r.on_fill(0, +1, 1.0, 5.0);
+  r.on_fill(0, +1, 1, 500);
 
   // Trigger daily loss cap by simulating more cost
-  for (int i=0;i<200;++i) r.on_fill(0, +1, 1.0, 5.0);
-  auto rr3 = r.check(1, -1, 0.5, 5.0);
+  for (int i=0;i<200;++i) r.on_fill(0, +1, 1, 500);
+  auto rr3 = r.check(1, -1, 1, 500);
   REQUIRE(rr3.allowed == false);
 }
+
+TEST_CASE("Risk arithmetic is exact in ticks and Money", "[risk]") {
+  TickTable ticks(2, {0.01, 0.25});
+  REQUIRE(ticks.tick_value(0) == 10000);
+  REQUIRE(ticks.tick_value(1) == 250000);
+  Risk r(ticks);
+  // 1% cost of 3 x 401 ticks of 0.25 = 3.0075 per fill; no drift after many fills
+  for (int i=0;i<100000;++i) r.on_fill(1, +1, 3, 401);
+  REQUIRE(r.pnl() == -100000LL * (3 * 401 * 250000LL / 100));
+  REQUIRE(money_to_double(r.pnl()) == -300750.0);
+  REQUIRE(ticks.to_price(1, 401) == 100.25);
+}
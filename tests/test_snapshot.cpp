@@ -0,0 +1,203 @@
+#include <catch2/catch_amalgamated.hpp>
+#include "snapshot.hpp"
+#include "strategy.hpp"
+#include "risk.hpp"
+#include "router.hpp"
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+using namespace nhft;
+
+TEST_CASE("State file restores strategy, risk and router after restart", "[snapshot]") {
+  namespace fs = std::filesystem;
+  fs::create_directories("out/snapshot_test");
+  std::string path = "out/snapshot_test/engine.state";
+  fs::remove(path);
+  const int S = 3;
+  TickTable ticks(S);
+  std::vector<int64_t> a_prev(S), a_pos(S);
+  std::vector<double> a_ewma(S), a_ewvar(S);
+  Money a_pnl = 0; uint64_t a_blocks = 0;
+  {
+    Strategy strat(S); Risk risk(ticks); Router router(7, "out/snapshot_test/trades0.csv", ticks);
+    StateFile st;
+    REQUIRE(st.open(path, ticks, 1024));
+    EngineCursor cur;
+    REQUIRE(st.restore(strat, risk, router, cur) == false); // fresh file is cold
+    for (int i=0;i<500;++i) strat.on_mid(i % S, 20000 + (i % 7) * 20);
+    for (uint64_t k=1;k<=10;++k) { router.ioc_fill(k, 0, 0, +1, 1, 10001, "x"); risk.on_fill(0, +1, 1, 10001); st.record_fill(k, k, 0, +1, 1, 10001); }
+    st.checkpoint(strat, risk, EngineCursor{500, 10});
+    // Fill routed after the checkpoint must survive via the order log
+    router.ioc_fill(11, 0, 1, -1, 2, 4999, "x"); risk.on_fill(1, -1, 2, 4999); st.record_fill(11, 11, 1, -1, 2, 4999);
+    strat.save_state(a_prev.data(), a_ewma.data(), a_ewvar.data());
+    risk.save_state(a_pos.data(), a_pnl, a_blocks);
+  }
+  Strategy strat(S); Risk risk(ticks); Router router(7, "out/snapshot_test/trades1.csv", ticks);
+  StateFile st;
+  REQUIRE(st.open(path, ticks, 1024));
+  EngineCursor cur;
+  REQUIRE(st.restore(strat, risk, router, cur));
+  REQUIRE(cur.events == 500);
+  REQUIRE(cur.order_seq == 11);
+  std::vector<int64_t> b_prev(S), b_pos(S);
+  std::vector<double> b_ewma(S), b_ewvar(S);
+  Money b_pnl = 0; uint64_t b_blocks = 0;
+  strat.save_state(b_prev.data(), b_ewma.data(), b_ewvar.data());
+  risk.save_state(b_pos.data(), b_pnl, b_blocks);
+  REQUIRE(b_prev == a_prev);
+  REQUIRE(b_ewma == a_ewma);
+  REQUIRE(b_ewvar == a_ewvar);
+  REQUIRE(b_pos == a_pos);
+  REQUIRE(b_pnl == a_pnl);
+  // Re-sending an order from before the restart is caught as a duplicate
+  REQUIRE(router.ioc_fill(11, 0, 1, -1, 2, 4999, "x") == false);
+  REQUIRE(router.idempotency_violations() == 1);
+}
+
+TEST_CASE("State file falls back to the older slot when the newest is corrupt", "[snapshot]") {
+  namespace fs = std::filesystem;
+  fs::create_directories("out/snapshot_test");
+  std::string path = "out/snapshot_test/corrupt.state";
+  fs::remove(path);
+  const int S = 2;
+  TickTable ticks(S);
+  {
+    Strategy strat(S); Risk risk(ticks); Router router(7, "out/snapshot_test/trades2.csv", ticks);
+    StateFile st;
+    REQUIRE(st.open(path, ticks, 64));
+    st.checkpoint(strat, risk, EngineCursor{100, 0}); // slot A, generation 1
+    st.checkpoint(strat, risk, EngineCursor{200, 0}); // slot B, generation 2
+  }
+  {
+    // Flip a byte inside slot B's payload (header 64B + slot A)
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    size_t slot_bytes = 64 + 4 * sizeof(uint64_t) * S;
+    f.seekp((std::streamoff)(64 + slot_bytes + 24));
+    char c = 0x5a; f.write(&c, 1);
+  }
+  Strategy strat(S); Risk risk(ticks); Router router(7, "out/snapshot_test/trades3.csv", ticks);
+  StateFile st;
+  REQUIRE(st.open(path, ticks, 64));
+  EngineCursor cur;
+  REQUIRE(st.restore(strat, risk, router, cur));
+  REQUIRE(cur.events == 100);
+}
+
+TEST_CASE("Checkpoint after a fallback restore keeps the surviving slot", "[snapshot]") {
+  namespace fs = std::filesystem;
+  fs::create_directories("out/snapshot_test");
+  std::string path = "out/snapshot_test/fallback.state";
+  fs::remove(path);
+  const int S = 2;
+  TickTable ticks(S);
+  const size_t slot_bytes = 64 + 4 * sizeof(uint64_t) * S;
+  auto corrupt_slot = [&](int slot) {
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekg((std::streamoff)(64 + slot * slot_bytes + 24));
+    char c = 0; f.read(&c, 1);
+    c = (char)(c ^ 0x5a);
+    f.seekp((std::streamoff)(64 + slot * slot_bytes + 24));
+    f.write(&c, 1);
+  };
+  {
+    Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+    StateFile st;
+    REQUIRE(st.open(path, ticks, 64));
+    st.checkpoint(strat, risk, EngineCursor{100, 0}); // slot A, generation 1
+    st.checkpoint(strat, risk, EngineCursor{200, 0}); // slot B, generation 2
+  }
+  corrupt_slot(1);
+  {
+    // Restores A; the next checkpoint must go to B, not over A
+    Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+    StateFile st;
+    REQUIRE(st.open(path, ticks, 64));
+    EngineCursor cur;
+    REQUIRE(st.restore(strat, risk, router, cur));
+    REQUIRE(cur.events == 100);
+    st.checkpoint(strat, risk, EngineCursor{300, 0});
+  }
+  {
+    Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+    StateFile st;
+    REQUIRE(st.open(path, ticks, 64));
+    EngineCursor cur;
+    REQUIRE(st.restore(strat, risk, router, cur));
+    REQUIRE(cur.events == 300);
+  }
+  // A crash while sealing that checkpoint still leaves A
+  corrupt_slot(1);
+  Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+  StateFile st;
+  REQUIRE(st.open(path, ticks, 64));
+  EngineCursor cur;
+  REQUIRE(st.restore(strat, risk, router, cur));
+  REQUIRE(cur.events == 100);
+}
+
+TEST_CASE("State file written with other tick sizes starts cold", "[snapshot]") {
+  namespace fs = std::filesystem;
+  fs::create_directories("out/snapshot_test");
+  std::string path = "out/snapshot_test/ticks.state";
+  fs::remove(path);
+  const int S = 2;
+  TickTable ticks(S, {0.01, 0.05});
+  {
+    Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+    StateFile st;
+    REQUIRE(st.open(path, ticks, 64));
+    st.checkpoint(strat, risk, EngineCursor{100, 0});
+  }
+  {
+    // Same symbol count, one tick size changed: positions and mids would be misread
+    TickTable other(S, {0.01, 0.10});
+    Strategy strat(S); Risk risk(other); Router router(7, "", other);
+    StateFile st;
+    REQUIRE(st.open(path, other, 64));
+    EngineCursor cur;
+    REQUIRE(st.restore(strat, risk, router, cur) == false);
+  }
+  // The file was reinitialized for the new table, so the old one no longer matches either
+  Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+  StateFile st;
+  REQUIRE(st.open(path, ticks, 64));
+  EngineCursor cur;
+  REQUIRE(st.restore(strat, risk, router, cur) == false);
+}
+
+TEST_CASE("State file whose order log overflowed starts cold", "[snapshot]") {
+  namespace fs = std::filesystem;
+  fs::create_directories("out/snapshot_test");
+  std::string path = "out/snapshot_test/overflow.state";
+  fs::remove(path);
+  const int S = 2;
+  TickTable ticks(S);
+  {
+    Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+    StateFile st;
+    REQUIRE(st.open(path, ticks, 4));
+    for (uint64_t k=1;k<=6;++k) { risk.on_fill(0, +1, 1, 10001); st.record_fill(k, k, 0, +1, 1, 10001); }
+    REQUIRE(st.log_dropped() == 2);
+    st.checkpoint(strat, risk, EngineCursor{100, 6});
+    REQUIRE(st.checkpoints() == 1);
+  }
+  {
+    // The checkpoint verifies, but two fills (and their IDs) were never logged
+    Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+    StateFile st;
+    REQUIRE(st.open(path, ticks, 4));
+    EngineCursor cur;
+    REQUIRE(st.restore(strat, risk, router, cur) == false);
+    REQUIRE(cur.events == 0);
+    REQUIRE(st.log_dropped() == 0);
+    st.checkpoint(strat, risk, EngineCursor{50, 0});
+  }
+  // The reinitialized file warm-starts again once nothing is dropped
+  Strategy strat(S); Risk risk(ticks); Router router(7, "", ticks);
+  StateFile st;
+  REQUIRE(st.open(path, ticks, 4));
+  EngineCursor cur;
+  REQUIRE(st.restore(strat, risk, router, cur));
+  REQUIRE(cur.events == 50);
+}
@@ -42,7 +42,8 @@ struct failure : public std::exception {
   static mini_catch2::Registrar CATCH2_UNIQUE_REGISTRAR_(name, CATCH2_UNIQUE_TEST_); \
   static void CATCH2_UNIQUE_TEST_()
 
-#define CATCH2_CONCAT_(a,b) a##b
+#define CATCH2_CONCAT_IMPL_(a,b) a##b
+#define CATCH2_CONCAT_(a,b) CATCH2_CONCAT_IMPL_(a,b)
 #define CATCH2_UNIQUE_TEST_ CATCH2_CONCAT_(_mini_catch_test_, __LINE__)
 #define CATCH2_UNIQUE_REGISTRAR_ CATCH2_CONCAT_(_mini_catch_registrar_, __LINE__)
 